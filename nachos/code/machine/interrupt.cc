@@ -178,6 +178,31 @@ Interrupt::OneTick()
     }
 }
 
+//----------------------------------------------------------------------
+// Interrupt::OneRound
+// 	Multiprocessor version of OneTick for user instructions.  Called
+//	once every CPU has executed one instruction: the CPUs run in
+//	parallel, so simulated time advances by a single tick.  The user
+//	ticks themselves are counted per CPU, by ProcessorTick.
+//
+//	Context switches requested by interrupt handlers are made by each
+//	CPU itself (see PreemptProcessors), not here.
+//----------------------------------------------------------------------
+void
+Interrupt::OneRound()
+{
+    IntStatus old = level;
+
+    stats->totalTicks += UserTick;
+    DEBUG('i', "\n== Tick %d ==\n", stats->totalTicks);
+
+    ChangeLevel(old, IntOff);		// interrupt handlers run with
+					// interrupts disabled
+    while (CheckIfDue(FALSE))		// check for pending interrupts
+	;
+    ChangeLevel(IntOff, old);
+}
+
 //----------------------------------------------------------------------
 // Interrupt::YieldOnReturn
 // 	Called from within an interrupt handler, to cause a context switch
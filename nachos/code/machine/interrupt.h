@@ -92,6 +92,8 @@ class Interrupt {
 
     void Halt(); 			// quit and print out stats
     
+    bool InHandler() { return inHandler; }
+					// are we running an interrupt handler?
     void YieldOnReturn();		// cause a context switch on return 
 					// from an interrupt handler
 
@@ -111,6 +113,9 @@ class Interrupt {
     					// by the hardware device simulators.
     
     void OneTick();       		// Advance simulated time
+    void OneRound();			// Advance simulated time after every
+					// CPU has executed an instruction
+					// (multiprocessor mode)
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
@@ -39,7 +39,10 @@ Machine::Run()
     for (;;) {
         currentThread->IncInstructionCount();
         OneInstruction(instr);
-	interrupt->OneTick();
+	if (numCPUs > 1)
+	    ProcessorTick();		// the other CPUs execute theirs
+	else
+	    interrupt->OneTick();
 	if (singleStep && (runUntilTime <= stats->totalTicks))
 	  Debugger();
     }
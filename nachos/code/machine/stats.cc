@@ -10,6 +10,7 @@
 #include "copyright.h"
 #include "utility.h"
 #include "stats.h"
+#include "list.h"
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -22,6 +23,313 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    for (int i = 0; i < BURST_ERROR_BUCKETS; i++)
+	burst_abs_error_hist[i] = burst_rel_error_hist[i] = 0;
+    for (int i = 0; i < MAX_CPUS; i++)
+	cpu_busy_ticks[i] = cpu_migrations[i] = 0;
+    for (int i = 0; i < WAIT_HIST_BUCKETS; i++)
+	thread_wait_hist[i] = ready_wait_hist[i] = wake_latency_hist[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordShare
+// 	Remember the CPU share a job achieved under proportional-share
+//	scheduling, for Print.  Called as each job exits.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordShare(int pid, int tickets, int cpuTicks, double entitled,
+			int window)
+{
+    ShareRecord *record = new ShareRecord;
+
+    record->pid = pid;
+    record->tickets = tickets;
+    record->cpuTicks = cpuTicks;
+    record->entitled = entitled;
+    record->window = window;
+    if (share_records == NULL)
+	share_records = new List;
+    share_records->Append((void *)record);
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordBurstError
+// 	Account the error of one CPU burst prediction, made before the
+//	burst ran, in the totals and histograms.
+//
+//	"actual" is the length of the burst (> 0).
+//	"predicted" is the length the scheduler expected.
+//----------------------------------------------------------------------
+
+// Upper bounds of the relative error buckets, except the last
+static double relErrorBound[BURST_ERROR_BUCKETS - 1] = {
+    0.10, 0.25, 0.50, 1.0, 2.0, 4.0, 8.0
+};
+
+void
+Statistics::RecordBurstError(int actual, double predicted)
+{
+    double absError = actual - predicted;
+    double relError;
+    int i;
+
+    if (absError < 0)
+	absError = -absError;
+    relError = absError / actual;
+
+    burst_error_count++;
+    burst_abs_error_total += absError;
+    burst_rel_error_total += relError;
+
+    for (i = 0; i < BURST_ERROR_BUCKETS - 1; i++)
+	if (absError < (1 << (2 * i)))
+	    break;
+    burst_abs_error_hist[i]++;
+    for (i = 0; i < BURST_ERROR_BUCKETS - 1; i++)
+	if (relError < relErrorBound[i])
+	    break;
+    burst_rel_error_hist[i]++;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordPrediction
+// 	Remember how well one job's bursts were predicted, for Print.
+//	Called as each job exits.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordPrediction(int pid, int count, double absError,
+			double relError, double alpha)
+{
+    PredictionRecord *record = new PredictionRecord;
+
+    record->pid = pid;
+    record->count = count;
+    record->absError = absError;
+    record->relError = relError;
+    record->alpha = alpha;
+    if (prediction_records == NULL)
+	prediction_records = new List;
+    prediction_records->Append((void *)record);
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordDeadline
+// 	Account one job instance that completed "lateness" ticks after
+//	its deadline (<= 0 if it met the deadline).
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordDeadline(int lateness)
+{
+    deadline_instances++;
+    if (lateness > 0) {
+	deadline_misses++;
+	deadline_lateness_total += lateness;
+	if (lateness > deadline_lateness_max)
+	    deadline_lateness_max = lateness;
+    }
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordDeadlineJob
+// 	Remember how a job with a deadline fared, for Print.  Called as
+//	each such job exits.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordDeadlineJob(int pid, int deadline, int period,
+			int instances, int misses, int maxLateness)
+{
+    DeadlineRecord *record = new DeadlineRecord;
+
+    record->pid = pid;
+    record->deadline = deadline;
+    record->period = period;
+    record->instances = instances;
+    record->misses = misses;
+    record->maxLateness = maxLateness;
+    if (deadline_records == NULL)
+	deadline_records = new List;
+    deadline_records->Append((void *)record);
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordIOBurst
+// 	Account the CPU time a thread used between two blocking calls
+//	(or before its exit), preempted or not.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordIOBurst(int burst)
+{
+    if (io_burst_count == 0 || burst < io_burst_min)
+	io_burst_min = burst;
+    if (burst > io_burst_max)
+	io_burst_max = burst;
+    io_burst_count++;
+    io_burst_total += burst;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordJoinWait
+// 	Account one Join, which waited "wait" ticks for the child to
+//	exit (0 if the child had already exited).
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordJoinWait(int wait)
+{
+    join_count++;
+    if (wait > 0) {
+	join_blocked++;
+	join_wait_total += wait;
+	if (wait > join_wait_max)
+	    join_wait_max = wait;
+    }
+}
+
+//----------------------------------------------------------------------
+// WaitBucket, WaitBucketTop
+// 	Map a wait of "ticks" to its histogram bucket, and a bucket back to
+//	the longest wait it holds.
+//----------------------------------------------------------------------
+
+static int
+WaitBucket(int ticks)
+{
+    int shift = 0;
+
+    if (ticks < 8)
+	return (ticks < 0) ? 0 : ticks;
+    while ((ticks >> shift) >= 16)
+	shift++;
+    return (shift + 1) * 8 + ((ticks >> shift) & 7);
+}
+
+static int
+WaitBucketTop(int bucket)
+{
+    int shift = bucket / 8 - 1;
+
+    if (bucket < 8)
+	return bucket;
+    return ((8 + bucket % 8 + 1) << shift) - 1;
+}
+
+//----------------------------------------------------------------------
+// WaitPercentile
+// 	Return the wait that "percent" percent of the "count" waits in
+//	"hist" did not exceed, rounded up to the top of its bucket but
+//	never beyond "max", the longest wait seen.
+//----------------------------------------------------------------------
+
+int
+WaitPercentile(int *hist, int count, int max, double percent)
+{
+    int rank = (int)(count * percent / 100.0 + 0.999999);
+    int seen = 0;
+
+    for (int i = 0; i < WAIT_HIST_BUCKETS; i++) {
+	seen += hist[i];
+	if (seen >= rank && seen > 0)
+	    return (WaitBucketTop(i) < max) ? WaitBucketTop(i) : max;
+    }
+    return max;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordWait
+// 	Account one stay of a thread on a ready queue, of "wait" ticks.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordWait(int wait)
+{
+    ready_wait_count++;
+    ready_wait_total += wait;
+    if (wait > ready_wait_max)
+	ready_wait_max = wait;
+    ready_wait_hist[WaitBucket(wait)]++;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordThreadWait
+// 	Account the total time an exiting thread spent on ready queues,
+//	for the percentiles of the thread wait times.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordThreadWait(int wait)
+{
+    if (wait > thread_wait_max)
+	thread_wait_max = wait;
+    thread_wait_hist[WaitBucket(wait)]++;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordWakeLatency
+// 	Account the ticks between a blocked thread being woken up (by the
+//	timer, a Join or a semaphore) and its getting the CPU.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordWakeLatency(int latency)
+{
+    wake_count++;
+    wake_latency_total += latency;
+    if (latency > wake_latency_max)
+	wake_latency_max = latency;
+    wake_latency_hist[WaitBucket(latency)]++;
+}
+
+//----------------------------------------------------------------------
+// Statistics::AddGroup
+// 	Return the id of the fair-share group "name", registering it with
+//	CPU share "share" if it is new.  The first share given for a group
+//	is the one that counts.  Returns -1 if there are too many groups.
+//----------------------------------------------------------------------
+
+int
+Statistics::AddGroup(char *name, int share)
+{
+    GroupRecord *record;
+    int i;
+
+    for (i = 0; i < num_groups; i++)
+	if (!strcmp(group_records[i]->name, name))
+	    return i;
+    if (num_groups == MAX_GROUPS)
+	return -1;
+
+    record = new GroupRecord;
+    strncpy(record->name, name, GROUP_NAME_LEN - 1);
+    record->name[GROUP_NAME_LEN - 1] = '\0';
+    record->share = share;
+    record->cpuTicks = 0;
+    record->entitled = 0.0;
+    record->window = 0;
+    group_records[num_groups] = record;
+    return num_groups++;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RecordGroupShare
+// 	Add the CPU a group got, and was entitled to, over a stretch of
+//	time during which it had runnable threads.  Called by the scheduler
+//	each time a group runs out of runnable threads.
+//----------------------------------------------------------------------
+
+void
+Statistics::RecordGroupShare(int group, int cpuTicks, double entitled,
+			int window)
+{
+    GroupRecord *record = group_records[group];
+
+    record->cpuTicks += cpuTicks;
+    record->entitled += entitled;
+    record->window += window;
 }
 
 //----------------------------------------------------------------------
@@ -42,6 +350,19 @@ Statistics::Print()
     printf("Total wait time=%d\n",wait_time_total);
     printf("Thread count =%d\n",thread_count);
     printf("Average wait time %f\n", avg_wait);
+    printf("Maximum wait time %d\n", thread_wait_max);
+    printf("99th percentile wait time %d\n", WaitPercentile(thread_wait_hist,
+	thread_count, thread_wait_max, 99.0));
+    if (ready_wait_count > 0)
+        printf("Ready queue waits %d: average %f, maximum %d, 99th percentile %d\n",
+	    ready_wait_count, ready_wait_total / ready_wait_count, ready_wait_max,
+	    WaitPercentile(ready_wait_hist, ready_wait_count, ready_wait_max, 99.0));
+    if (wake_count > 0)
+        printf("Wake-up to run latency %d: average %f, maximum %d, 99th percentile %d\n",
+	    wake_count, wake_latency_total / wake_count, wake_latency_max,
+	    WaitPercentile(wake_latency_hist, wake_count, wake_latency_max, 99.0));
+    if (wakeup_preemptions > 0)
+        printf("Preemptions on wake-up: %d\n", wakeup_preemptions);
 
 
 
@@ -51,6 +372,111 @@ Statistics::Print()
     printf("CPU Burst count %d\n", cpu_burst_count);
     printf("Total CPU Burst time %d\n", cpu_burst_total);
     printf("CPU Utilization: %f\n", util);
+    if (srtf_preemptions > 0)
+        printf("Preemptions by shorter jobs: %d\n", srtf_preemptions);
+    if (edf_preemptions > 0)
+        printf("Preemptions by earlier deadlines: %d\n", edf_preemptions);
+
+    if (join_count > 0) {
+        printf("\nJoin Wait Statistics\n");
+        printf("Joins %d, of which blocked %d\n", join_count, join_blocked);
+        printf("Total join wait time %d\n", join_wait_total);
+        printf("Average join wait time %f\n", join_wait_total / (double)join_count);
+        printf("Maximum join wait time %d\n", join_wait_max);
+    }
+
+    if (stack_pool_hits + stack_pool_misses > 0)
+        printf("\nThread stacks %d, reused from the pool %d\n",
+	    stack_pool_hits + stack_pool_misses, stack_pool_hits);
+
+    if (num_cpus > 1) {
+        printf("\nPer-CPU Statistics\n");
+        printf("%4s %12s %12s %11s\n", "cpu", "busy ticks", "utilization",
+		"migrations");
+        for (int i = 0; i < num_cpus; i++)
+            printf("%4d %12d %12f %11d\n", i, cpu_busy_ticks[i],
+		cpu_busy_ticks[i] / (double)totalTicks, cpu_migrations[i]);
+    }
+
+    if (burst_error_count > 0) {
+        int i;
+
+        printf("\nBurst Prediction Statistics\n");
+        printf("Predicted bursts %d\n", burst_error_count);
+        printf("Mean absolute error %f\n", burst_abs_error_total / burst_error_count);
+        printf("Mean relative error %f\n", burst_rel_error_total / burst_error_count);
+        printf("Absolute error histogram (ticks):\n");
+        for (i = 0; i < BURST_ERROR_BUCKETS - 1; i++)
+            printf("  < %5d: %d\n", 1 << (2 * i), burst_abs_error_hist[i]);
+        printf("  >=%5d: %d\n", 1 << (2 * i), burst_abs_error_hist[i]);
+        printf("Relative error histogram:\n");
+        for (i = 0; i < BURST_ERROR_BUCKETS - 1; i++)
+            printf("  < %4d%%: %d\n", (int)(relErrorBound[i] * 100), burst_rel_error_hist[i]);
+        printf("  >=%4d%%: %d\n", (int)(relErrorBound[i - 1] * 100), burst_rel_error_hist[i]);
+        if (prediction_records != NULL) {
+            printf("%6s %8s %14s %14s %8s\n", "pid", "bursts", "mean abs err",
+		"mean rel err", "alpha");
+            for (ListElement *e = prediction_records->first; e != NULL; e = e->next) {
+                PredictionRecord *r = (PredictionRecord *)e->item;
+                printf("%6d %8d %14f %14f %8f\n", r->pid, r->count,
+		    r->absError / r->count, r->relError / r->count, r->alpha);
+            }
+        }
+    }
+
+    if (deadline_instances > 0 || deadline_rejected > 0) {
+        printf("\nDeadline Statistics\n");
+        printf("Instances with a deadline %d\n", deadline_instances);
+        printf("Deadline misses %d\n", deadline_misses);
+        if (deadline_instances > 0)
+            printf("Miss ratio %f\n", deadline_misses / (double)deadline_instances);
+        if (deadline_misses > 0)
+            printf("Average lateness of a miss %f\n",
+		deadline_lateness_total / (double)deadline_misses);
+        printf("Maximum lateness %d\n", deadline_lateness_max);
+        printf("Jobs rejected by admission control %d\n", deadline_rejected);
+        if (deadline_records != NULL) {
+            printf("%6s %9s %7s %10s %7s %13s\n", "pid", "deadline", "period",
+		"instances", "misses", "max lateness");
+            for (ListElement *e = deadline_records->first; e != NULL; e = e->next) {
+                DeadlineRecord *r = (DeadlineRecord *)e->item;
+                printf("%6d %9d %7d %10d %7d %13d\n", r->pid, r->deadline,
+		    r->period, r->instances, r->misses, r->maxLateness);
+            }
+        }
+    }
+
+    if (share_records != NULL) {
+        printf("\nProportional Share Statistics\n");
+        printf("%6s %8s %8s %13s %15s\n", "pid", "tickets", "cpu",
+		"target share", "achieved share");
+        for (ListElement *e = share_records->first; e != NULL; e = e->next) {
+            ShareRecord *r = (ShareRecord *)e->item;
+            double target = 0.0, achieved = 0.0;
+            if (r->window > 0) {
+                target = r->entitled / r->window;
+                achieved = r->cpuTicks / (double)r->window;
+            }
+            printf("%6d %8d %8d %13f %15f\n", r->pid, r->tickets,
+		r->cpuTicks, target, achieved);
+        }
+    }
+
+    if (num_groups > 0) {
+        printf("\nFair Share Group Statistics\n");
+        printf("%-15s %6s %8s %9s %13s %15s\n", "group", "share", "cpu",
+		"entitled", "target share", "achieved share");
+        for (int i = 0; i < num_groups; i++) {
+            GroupRecord *r = group_records[i];
+            double target = 0.0, achieved = 0.0;
+            if (r->window > 0) {
+                target = r->entitled / r->window;
+                achieved = r->cpuTicks / (double)r->window;
+            }
+            printf("%-15s %6d %8d %9.0f %13f %15f\n", r->name, r->share,
+		r->cpuTicks, r->entitled, target, achieved);
+        }
+    }
 
 
 
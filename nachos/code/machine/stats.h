@@ -13,6 +13,74 @@
 
 #include "copyright.h"
 
+class List;
+
+// CPU share achieved by one job under proportional-share scheduling,
+// against the share its tickets entitled it to.  "window" is the CPU
+// time used by all threads while the job was runnable; the target and
+// achieved shares are "entitled" and "cpuTicks" as fractions of it.
+
+class ShareRecord {
+  public:
+    int pid;
+    int tickets;
+    int cpuTicks;		// CPU ticks the job actually got
+    double entitled;		// CPU ticks its tickets entitled it to
+    int window;
+};
+
+// Burst prediction accuracy of one job under SJF or SRTF.
+
+class PredictionRecord {
+  public:
+    int pid;
+    int count;			// number of bursts predicted
+    double absError;		// sum of |actual - predicted|, in ticks
+    double relError;		// sum of |actual - predicted| / actual
+    double alpha;		// smoothing factor in use at exit
+};
+
+// Deadlines of one job with an SLA, under whatever policy ran it.
+
+class DeadlineRecord {
+  public:
+    int pid;
+    int deadline;		// relative deadline, in ticks
+    int period;			// 0 for a one-shot job
+    int instances;		// instances checked against their deadline
+    int misses;			// instances completed after their deadline
+    int maxLateness;		// worst lateness of an instance, in ticks
+};
+
+// CPU consumed by one fair-share group of batch jobs, against the CPU
+// its share entitled it to.  As for ShareRecord, "window" is the CPU time
+// used by all groups while the group had runnable threads.
+
+#define MAX_GROUPS		16
+#define GROUP_NAME_LEN		16
+
+class GroupRecord {
+  public:
+    char name[GROUP_NAME_LEN];
+    int share;
+    int cpuTicks;		// CPU ticks the group's threads got
+    double entitled;		// CPU ticks its share entitled it to
+    int window;
+};
+
+// Histogram buckets for burst prediction errors.  Absolute errors are
+// bucketed by powers of 4 ticks (<1, <4, <16, ...); relative errors by
+// the bounds in stats.cc (<10%, <25%, ...).  The last bucket is open.
+#define BURST_ERROR_BUCKETS	8
+
+// Histogram buckets for wait times, for their percentiles.  Waits under
+// 8 ticks have a bucket each; above that every power of 2 is split into
+// 8 buckets, so a percentile is known to within 1/8 of its value.
+#define WAIT_HIST_BUCKETS	256
+
+// Most CPUs that can be simulated with -ncpu.
+#define MAX_CPUS		16
+
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
 // many user instructions executed, etc.
@@ -50,9 +118,83 @@ class Statistics {
     int cpu_burst_max=0;
     int wait_time_total=0;
     int wait_count=0;
+    int thread_wait_max=0;	// longest total wait of a thread
+    int thread_wait_hist[WAIT_HIST_BUCKETS];
+    int ready_wait_count=0;	// times a thread was taken off a ready queue
+    double ready_wait_total=0;	// ... and the ticks it had waited there
+    int ready_wait_max=0;
+    int ready_wait_hist[WAIT_HIST_BUCKETS];
+    int wake_count=0;		// times a thread that woke up was dispatched
+    double wake_latency_total=0;	// ... and the ticks from wake-up to run
+    int wake_latency_max=0;
+    int wake_latency_hist[WAIT_HIST_BUCKETS];
+    int wakeup_preemptions=0;	// preemptions right at a wake-up
+    List *share_records=NULL;	// ShareRecords, in exit order
+    int srtf_preemptions=0;	// SRTF preemptions by a shorter job
+    int edf_preemptions=0;	// EDF preemptions by an earlier deadline
+
+    int deadline_instances=0;	// job instances with a deadline
+    int deadline_misses=0;	// ... completed after it
+    int deadline_lateness_total=0;	// sum of lateness of missed instances
+    int deadline_lateness_max=0;
+    int deadline_rejected=0;	// jobs refused by EDF admission control
+    List *deadline_records=NULL;	// DeadlineRecords, in exit order
+
+    int io_burst_count=0;	// CPU bursts between blocking calls,
+    int io_burst_total=0;	// counting the time before and after
+    int io_burst_min=0;		// any preemptions (not the main thread)
+    int io_burst_max=0;
+
+    int join_count=0;		// calls to Join
+    int join_blocked=0;		// ... that had to wait for the child
+    int join_wait_total=0;	// ticks parents spent waiting in Join
+    int join_wait_max=0;
+
+    int burst_error_count=0;	// CPU bursts whose length was predicted
+    double burst_abs_error_total=0;
+    double burst_rel_error_total=0;
+    int burst_abs_error_hist[BURST_ERROR_BUCKETS];
+    int burst_rel_error_hist[BURST_ERROR_BUCKETS];
+    List *prediction_records=NULL;	// PredictionRecords, in exit order
+
+    int num_groups=0;		// fair-share groups named in the batch
+    GroupRecord *group_records[MAX_GROUPS];	// ... indexed by group id
+
+    int num_cpus=1;		// simulated CPUs
+    int cpu_busy_ticks[MAX_CPUS];	// user instructions run by each CPU
+    int cpu_migrations[MAX_CPUS];	// threads each CPU stole
+
+    int stack_pool_hits=0;	// thread stacks reused from the pool
+    int stack_pool_misses=0;	// ... and allocated from the host
 
     Statistics(); 		// initialize everything to zero
 
+    void RecordShare(int pid, int tickets, int cpuTicks, double entitled,
+			int window);	// note a job's achieved share
+    void RecordBurstError(int actual, double predicted);
+				// note one burst prediction
+    void RecordPrediction(int pid, int count, double absError,
+			double relError, double alpha);
+				// note a job's prediction accuracy
+    void RecordDeadline(int lateness);
+				// note one completed job instance
+    void RecordDeadlineJob(int pid, int deadline, int period, int instances,
+			int misses, int maxLateness);
+				// note a deadline job's record
+    void RecordIOBurst(int burst);
+				// note a burst that ended by blocking
+    void RecordJoinWait(int wait);
+				// note how long a Join waited
+    void RecordWait(int wait);	// note one stay on a ready queue
+    void RecordThreadWait(int wait);
+				// note a thread's total wait, at exit
+    void RecordWakeLatency(int latency);
+				// note the wait of a thread that woke up
+    int AddGroup(char *name, int share);
+				// the id of a fair-share group
+    void RecordGroupShare(int group, int cpuTicks, double entitled,
+			int window);	// note a group's achieved share
+
     void Print();		// print collected statistics
 };
 
@@ -64,6 +206,9 @@ class Statistics {
 // in the kernel measured by the number of calls to enable interrupts,
 // these time constants are none too exact.
 
+extern int WaitPercentile(int *hist, int count, int max, double percent);
+				// a percentile of a wait histogram
+
 #define UserTick 	1	// advance for each user-level instruction 
 #define SystemTick 	10 	// advance each time interrupts are enabled
 #define RotationTime 	500 	// time disk takes to rotate one sector
@@ -452,6 +452,22 @@ Random()
     return rand();
 }
 
+//----------------------------------------------------------------------
+// HostTime
+// 	Return the host's wall-clock time, in seconds.  Used to measure
+//	how long the simulator itself takes to do something -- this has
+//	nothing to do with simulated time (stats->totalTicks).
+//----------------------------------------------------------------------
+
+double
+HostTime()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
 //----------------------------------------------------------------------
 // AllocBoundedArray
 // 	Return an array, with the two pages just before 
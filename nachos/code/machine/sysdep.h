@@ -50,6 +50,8 @@ extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
 extern void RandomInit(unsigned seed);
 extern int Random();
 
+extern double HostTime();
+
 // Allocate, de-allocate an array, such that de-referencing
 // just beyond either end of the array will cause an error
 extern char *AllocBoundedArray(int size);
@@ -49,8 +49,7 @@ Timer::Timer(VoidFunctionPtr timerHandler, int callArg, bool doRandom, int quant
     quantum_timer = quantum;
 
     // schedule the first interrupt from the timer device
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt); 
+    ScheduleInterrupt(TimeOfNextInterrupt());
 }
 
 //----------------------------------------------------------------------
@@ -62,9 +61,11 @@ Timer::Timer(VoidFunctionPtr timerHandler, int callArg, bool doRandom, int quant
 void 
 Timer::TimerExpired() 
 {
+    if (stats->totalTicks < nextInterrupt)
+	return;			// cancelled by Reprogram
+
     // schedule the next timer device interrupt
-    interrupt->Schedule(TimerHandler, (int) this, TimeOfNextInterrupt(), 
-		TimerInt);
+    ScheduleInterrupt(TimeOfNextInterrupt());
 
     // invoke the Nachos interrupt handler for this device
     (*handler)(arg);
@@ -84,3 +85,32 @@ Timer::TimeOfNextInterrupt()
     else
 	return quantum_timer; 
 }
+
+//----------------------------------------------------------------------
+// Timer::Reprogram
+//      Make the next interrupt come "ticks" from now, as a scheduler
+//	does to give the thread it dispatches a time slice of its own.
+//	Later interrupts come every quantum_timer ticks, as before.  The
+//	interrupt that was pending is ignored when it goes off, since the
+//	interrupt list cannot take it back.
+//----------------------------------------------------------------------
+
+void
+Timer::Reprogram(int ticks)
+{
+    ASSERT(ticks > 0);
+    ScheduleInterrupt(ticks);
+}
+
+//----------------------------------------------------------------------
+// Timer::ScheduleInterrupt
+//      Arrange for the timer interrupt to go off "fromNow" ticks from
+//	now, superseding any that is pending.
+//----------------------------------------------------------------------
+
+void
+Timer::ScheduleInterrupt(int fromNow)
+{
+    nextInterrupt = stats->totalTicks + fromNow;
+    interrupt->Schedule(TimerHandler, (int) this, fromNow, TimerInt);
+}
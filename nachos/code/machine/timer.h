@@ -41,8 +41,14 @@ class Timer {
     int TimeOfNextInterrupt();  // figure out when the timer will generate
 				// its next interrupt 
 
+    void Reprogram(int ticks);	// next interrupt "ticks" from now instead
+				// of when it was due; then periodic again
 
   private:
+    void ScheduleInterrupt(int fromNow);
+
+    int nextInterrupt;		// when the interrupt that counts is due;
+				// earlier ones were cancelled
     bool randomize;		// set if we need to use a random timeout delay
     VoidFunctionPtr handler;	// timer interrupt handler 
     int arg;			// argument to pass to interrupt handler
@@ -0,0 +1,172 @@
+// bursthistory.cc
+//	Routines to load, consult, and update the per-executable burst
+//	history kept in a host file.
+//
+//	The history is small (one line per distinct executable), so it is
+//	kept in a List and the whole file is rewritten whenever a job
+//	finishes; a run that crashes loses at most the jobs still running.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "bursthistory.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// BurstHistory::BurstHistory
+//	Load the history from the host file "historyFile".  A missing file
+//	is an empty history; it is created on the first Save.
+//----------------------------------------------------------------------
+
+BurstHistory::BurstHistory(char *historyFile)
+{
+    FILE *fp;
+    BurstHistoryEntry *entry;
+
+    fileName = historyFile;
+    entries = new List;
+
+    fp = fopen(fileName, "r");
+    if (fp == NULL)
+	return;
+    for (;;) {
+	entry = new BurstHistoryEntry;
+	if (fscanf(fp, "%lf %lf %d %127s", &entry->expectedBurst,
+		&entry->blocksPerRun, &entry->runs, entry->name) != 4) {
+	    delete entry;
+	    break;
+	}
+	entries->Append((void *)entry);
+    }
+    fclose(fp);
+    DEBUG('t', "Loaded burst history from %s\n", fileName);
+}
+
+//----------------------------------------------------------------------
+// BurstHistory::~BurstHistory
+//	De-allocate the history.
+//----------------------------------------------------------------------
+
+BurstHistory::~BurstHistory()
+{
+    BurstHistoryEntry *entry;
+
+    while ((entry = (BurstHistoryEntry *)entries->Remove()) != NULL)
+	delete entry;
+    delete entries;
+}
+
+//----------------------------------------------------------------------
+// BurstHistory::Lookup
+//	Return the entry for "execName", or NULL if it has never run.
+//----------------------------------------------------------------------
+
+BurstHistoryEntry *
+BurstHistory::Lookup(char *execName)
+{
+    for (ListElement *e = entries->first; e != NULL; e = e->next) {
+	BurstHistoryEntry *entry = (BurstHistoryEntry *)e->item;
+	if (!strcmp(entry->name, execName))
+	    return entry;
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// BurstHistory::Seed
+//	Called when a batch job running "execName" is created.  Remember
+//	which executable the thread runs, for ExpectedBurst and Learn.
+//----------------------------------------------------------------------
+
+void
+BurstHistory::Seed(NachOSThread *thread, char *execName)
+{
+    BurstHistoryEntry *entry = Lookup(execName);
+
+    if (entry == NULL) {
+	entry = new BurstHistoryEntry;
+	strncpy(entry->name, execName, BURST_HISTORY_NAME_LEN - 1);
+	entry->name[BURST_HISTORY_NAME_LEN - 1] = '\0';
+	entry->expectedBurst = 0.0;
+	entry->blocksPerRun = 0.0;
+	entry->runs = 0;
+	entries->Append((void *)entry);
+    }
+    thread->execName = entry->name;
+}
+
+//----------------------------------------------------------------------
+// BurstHistory::ExpectedBurst
+//	Return the burst estimate to start "thread" with: the learned one
+//	if its executable has run before, else 0.  Called by the policies
+//	that predict bursts, when they first see the thread.
+//----------------------------------------------------------------------
+
+double
+BurstHistory::ExpectedBurst(NachOSThread *thread)
+{
+    BurstHistoryEntry *entry;
+
+    if (thread->execName == NULL)
+	return 0.0;
+    entry = Lookup(thread->execName);
+    if (entry == NULL || entry->runs == 0)
+	return 0.0;
+    DEBUG('t', "Seeding %s (pid %d) with expected burst %f\n",
+	  thread->execName, thread->GetPID(), entry->expectedBurst);
+    return entry->expectedBurst;
+}
+
+//----------------------------------------------------------------------
+// BurstHistory::Learn
+//	Called when a thread whose bursts were predicted exits.  If it was
+//	a batch job, store "expectedBurst", the estimate it finished with,
+//	and fold its number of blocking calls into the executable's
+//	average.
+//----------------------------------------------------------------------
+
+void
+BurstHistory::Learn(NachOSThread *thread, double expectedBurst)
+{
+    BurstHistoryEntry *entry;
+
+    if (thread->execName == NULL)
+	return;
+    entry = Lookup(thread->execName);
+    ASSERT(entry != NULL);
+
+    entry->expectedBurst = expectedBurst;
+    if (entry->runs == 0)
+	entry->blocksPerRun = thread->blockCount;
+    else
+	entry->blocksPerRun = scheduler->alpha * thread->blockCount
+				+ (1 - scheduler->alpha) * entry->blocksPerRun;
+    entry->runs++;
+    Save();
+}
+
+//----------------------------------------------------------------------
+// BurstHistory::Save
+//	Rewrite the host file with the whole history.  Executables that
+//	were started but never learned from are left out.
+//----------------------------------------------------------------------
+
+void
+BurstHistory::Save()
+{
+    FILE *fp = fopen(fileName, "w");
+
+    if (fp == NULL) {
+	printf("Unable to write burst history %s\n", fileName);
+	return;
+    }
+    for (ListElement *e = entries->first; e != NULL; e = e->next) {
+	BurstHistoryEntry *entry = (BurstHistoryEntry *)e->item;
+	if (entry->runs > 0)
+	    fprintf(fp, "%f %f %d %s\n", entry->expectedBurst,
+		    entry->blocksPerRun, entry->runs, entry->name);
+    }
+    fclose(fp);
+}
@@ -0,0 +1,65 @@
+// bursthistory.h
+//	Data structures for a persistent record of how executables behave.
+//
+//	The SJF and SRTF schedulers predict each thread's next CPU burst
+//	from its past bursts, so every new job starts with no information
+//	and its first bursts are mispredicted.  The burst history keeps,
+//	per executable, the burst estimate its last run ended with and how
+//	often it blocked, in a file on the host, so that the next run of
+//	the same executable starts from there.
+//
+//	The file is plain text, one executable per line:
+//
+//		<expected burst> <blocks per run> <runs> <executable>
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef BURSTHISTORY_H
+#define BURSTHISTORY_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+
+#define BURST_HISTORY_FILE	"burst_history"
+#define BURST_HISTORY_NAME_LEN	128
+
+// What is known about one executable.
+
+class BurstHistoryEntry {
+  public:
+    char name[BURST_HISTORY_NAME_LEN];	// executable path, as in the batch file
+    double expectedBurst;		// learned burst estimate, in ticks
+    double blocksPerRun;		// average times a run blocked (I/O,
+					// sleep, join)
+    int runs;				// runs learned from, 0 if none yet
+};
+
+// The following class defines the history of all executables, loaded
+// from and saved to a host file.
+
+class BurstHistory {
+  public:
+    BurstHistory(char *historyFile);	// load the history from "historyFile"
+    ~BurstHistory();
+
+    void Seed(NachOSThread *thread, char *execName);
+					// Start a new job running "execName"
+    double ExpectedBurst(NachOSThread *thread);
+					// What earlier runs of its executable
+					// learned, 0 if nothing
+    void Learn(NachOSThread *thread, double expectedBurst);
+					// Fold a finished job into the
+					// history, and save it
+
+  private:
+    BurstHistoryEntry *Lookup(char *execName);	// NULL if unknown
+    void Save();
+
+    char *fileName;
+    List *entries;			// BurstHistoryEntries
+};
+
+#endif // BURSTHISTORY_H
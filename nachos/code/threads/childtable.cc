@@ -0,0 +1,160 @@
+// childtable.cc
+//	Routines to keep track of the children of a thread.  See
+//	childtable.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "childtable.h"
+
+//----------------------------------------------------------------------
+// ChildTable::ChildTable
+//	No children yet, and no buckets either.
+//----------------------------------------------------------------------
+
+ChildTable::ChildTable()
+{
+    buckets = NULL;
+    size = 0;
+    numChildren = 0;
+}
+
+ChildTable::~ChildTable()
+{
+    ChildRecord *record;
+
+    for (int i = 0; i < size; i++) {
+	while ((record = buckets[i]) != NULL) {
+	    buckets[i] = record->next;
+	    delete record;
+	}
+    }
+    delete [] buckets;
+}
+
+//----------------------------------------------------------------------
+// ChildTable::Grow
+//	Double the number of buckets, keeping at most one child per
+//	bucket on average, and rehash the children.
+//----------------------------------------------------------------------
+
+void
+ChildTable::Grow()
+{
+    ChildRecord **oldBuckets = buckets;
+    int oldSize = size;
+    ChildRecord *record;
+
+    size = (oldSize == 0) ? CHILD_TABLE_MIN_SIZE : 2 * oldSize;
+    buckets = new ChildRecord*[size];
+    for (int i = 0; i < size; i++)
+	buckets[i] = NULL;
+    for (int i = 0; i < oldSize; i++) {
+	while ((record = oldBuckets[i]) != NULL) {
+	    oldBuckets[i] = record->next;
+	    record->next = buckets[Hash(record->pid)];
+	    buckets[Hash(record->pid)] = record;
+	}
+    }
+    delete [] oldBuckets;
+}
+
+//----------------------------------------------------------------------
+// ChildTable::Add
+//	Note the new child "pid".  A record left with the same pid is that
+//	of a child destroyed without exiting, whose pid has been reused:
+//	the new child takes it over.
+//----------------------------------------------------------------------
+
+void
+ChildTable::Add(int pid)
+{
+    ChildRecord *record = Lookup(pid);
+
+    if (record == NULL) {
+	if (numChildren >= size)
+	    Grow();
+	record = new ChildRecord;
+	record->pid = pid;
+	record->next = buckets[Hash(pid)];
+	buckets[Hash(pid)] = record;
+	numChildren++;
+    }
+    record->exitCode = 0;
+    record->exited = FALSE;
+}
+
+//----------------------------------------------------------------------
+// ChildTable::Remove
+//	Forget the child "pid", if there is one.  Once the last child is
+//	gone the buckets go too, so a thread that forks and joins a burst
+//	of children does not keep a table sized for all of them.
+//----------------------------------------------------------------------
+
+void
+ChildTable::Remove(int pid)
+{
+    ChildRecord **link;
+    ChildRecord *record;
+
+    if (size == 0 || pid < 0)
+	return;
+    for (link = &buckets[Hash(pid)]; (record = *link) != NULL;
+					link = &record->next) {
+	if (record->pid == pid) {
+	    *link = record->next;
+	    delete record;
+	    if (--numChildren == 0) {
+		delete [] buckets;
+		buckets = NULL;
+		size = 0;
+	    }
+	    return;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// ChildTable::Lookup
+//	Return the record of the child "pid", or NULL if "pid" is not
+//	one of the children.
+//----------------------------------------------------------------------
+
+ChildRecord *
+ChildTable::Lookup(int pid)
+{
+    ChildRecord *record;
+
+    if (size == 0 || pid < 0)
+	return NULL;
+    for (record = buckets[Hash(pid)]; record != NULL; record = record->next) {
+	if (record->pid == pid)
+	    return record;
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ChildTable::Next
+//	Walk the children: return the one after "record", or the first
+//	one if "record" is NULL.  Return NULL when there are no more.
+//----------------------------------------------------------------------
+
+ChildRecord *
+ChildTable::Next(ChildRecord *record)
+{
+    int i = 0;
+
+    if (record != NULL) {
+	if (record->next != NULL)
+	    return record->next;
+	i = Hash(record->pid) + 1;
+    }
+    for (; i < size; i++) {
+	if (buckets[i] != NULL)
+	    return buckets[i];
+    }
+    return NULL;
+}
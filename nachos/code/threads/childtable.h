@@ -0,0 +1,60 @@
+// childtable.h
+//	Data structures for what a thread knows about its children: their
+//	pids, and the exit codes of those that have exited, for Join.
+//
+//	The records are kept in a hash table on the pid, which grows with
+//	the number of children, so looking up a child is O(1) and a thread
+//	can have any number of them.  A thread with no children, because it
+//	never forked or has joined with them all, holds no table.  Pids are
+//	handed out densely from 0, so the hash is just the low bits of the
+//	pid.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef CHILDTABLE_H
+#define CHILDTABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define CHILD_TABLE_MIN_SIZE	8	// buckets once there is a child
+
+// What a thread knows about one child.
+
+class ChildRecord {
+  public:
+    int pid;
+    int exitCode;			// valid once it has exited
+    bool exited;
+    ChildRecord *next;			// next record in the same bucket
+};
+
+// The following class defines the children of one thread.
+
+class ChildTable {
+  public:
+    ChildTable();			// no children
+    ~ChildTable();			// forget them all
+
+    void Add(int pid);			// a new child, not exited
+    void Remove(int pid);		// forget the child "pid", once it
+					// has been joined with
+    ChildRecord *Lookup(int pid);	// the child "pid", NULL if none
+    ChildRecord *Next(ChildRecord *record);
+					// the child after "record", in no
+					// particular order; the first if
+					// NULL, NULL after the last
+    int NumChildren() { return numChildren; }
+
+  private:
+    int Hash(int pid) { return pid & (size - 1); }
+    void Grow();			// double the buckets
+
+    ChildRecord **buckets;		// NULL while there are no children
+    int size;				// number of buckets, a power of 2
+    int numChildren;
+};
+
+#endif // CHILDTABLE_H
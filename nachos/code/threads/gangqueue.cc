@@ -0,0 +1,175 @@
+// gangqueue.cc
+//	Routines to manage the gang ready queue.
+//
+//	Every gang on gangList has at least one ready thread; threads only
+//	leave the current gang, which is not on the list.  So starting a
+//	turn always finds a thread to run.
+//
+//	NOTE: Mutual exclusion must be provided by the caller; the
+//	scheduler only touches the queue with interrupts disabled.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "gangqueue.h"
+
+//----------------------------------------------------------------------
+// GangRunQueue::GangRunQueue
+//	Initialize the queue, empty to start with.
+//----------------------------------------------------------------------
+
+GangRunQueue::GangRunQueue()
+{
+    for (int i = 0; i < GANG_HASH_SIZE; i++)
+	table[i] = NULL;
+    gangList = new List;
+    current = NULL;
+    slotsLeft = 0;
+    numInQueue = 0;
+}
+
+//----------------------------------------------------------------------
+// GangRunQueue::~GangRunQueue
+//	De-allocate the gangs.  The threads themselves are not ours to
+//	delete.
+//----------------------------------------------------------------------
+
+GangRunQueue::~GangRunQueue()
+{
+    Gang *gang;
+
+    for (int i = 0; i < GANG_HASH_SIZE; i++) {
+	while ((gang = table[i]) != NULL) {
+	    table[i] = gang->hashNext;
+	    delete gang->ready;
+	    delete gang;
+	}
+    }
+    delete gangList;
+}
+
+//----------------------------------------------------------------------
+// GangRunQueue::Lookup
+//	Return the gang with the given id.  If there is none, create an
+//	empty one when "create" is TRUE, else return NULL.
+//----------------------------------------------------------------------
+
+Gang *
+GangRunQueue::Lookup(int id, bool create)
+{
+    Gang **bucket = &table[id % GANG_HASH_SIZE];
+    Gang *gang;
+
+    for (gang = *bucket; gang != NULL; gang = gang->hashNext)
+	if (gang->id == id)
+	    return gang;
+    if (!create)
+	return NULL;
+
+    gang = new Gang;
+    gang->id = id;
+    gang->ready = new List;
+    gang->numReady = 0;
+    gang->queued = FALSE;
+    gang->hashNext = *bucket;
+    *bucket = gang;
+    return gang;
+}
+
+//----------------------------------------------------------------------
+// GangRunQueue::Insert
+//	Put "thread" at the tail of its gang, "gangId".  A gang that was
+//	not ready joins the end of the gang list, unless it holds the
+//	current turn.
+//----------------------------------------------------------------------
+
+void
+GangRunQueue::Insert(NachOSThread *thread, int gangId)
+{
+    Gang *gang = Lookup(gangId, TRUE);
+
+    gang->ready->Append((void *)thread);
+    gang->numReady++;
+    numInQueue++;
+    if (gang != current && !gang->queued) {
+	gangList->Append((void *)gang);
+	gang->queued = TRUE;
+    }
+}
+
+//----------------------------------------------------------------------
+// GangRunQueue::EndTurn
+//	The current gang has used up its slots, or has nothing ready.  It
+//	goes to the back of the gang list if it still has ready threads;
+//	otherwise it is forgotten until one of its threads is ready again.
+//----------------------------------------------------------------------
+
+void
+GangRunQueue::EndTurn()
+{
+    Gang *gang = current;
+    Gang **ptr;
+
+    current = NULL;
+    if (gang->numReady > 0) {
+	gangList->Append((void *)gang);
+	gang->queued = TRUE;
+	return;
+    }
+    for (ptr = &table[gang->id % GANG_HASH_SIZE]; *ptr != gang;
+		ptr = &(*ptr)->hashNext)
+	;
+    *ptr = gang->hashNext;
+    delete gang->ready;
+    delete gang;
+}
+
+//----------------------------------------------------------------------
+// GangRunQueue::RemoveNext
+//	Take the next thread off the queue: the next ready thread of the
+//	current gang while its turn lasts, else the first thread of the
+//	next gang, whose turn then begins.  A turn is as many slots as
+//	the gang had ready threads when it began.
+//
+// Returns:
+//	The thread to run, or NULL if no thread is ready.
+//----------------------------------------------------------------------
+
+NachOSThread *
+GangRunQueue::RemoveNext()
+{
+    NachOSThread *thread;
+
+    if (current != NULL && (slotsLeft <= 0 || current->numReady == 0))
+	EndTurn();
+    if (current == NULL) {
+	current = (Gang *)gangList->Remove();
+	if (current == NULL)
+	    return NULL;
+	current->queued = FALSE;
+	slotsLeft = current->numReady;
+    }
+
+    thread = (NachOSThread *)current->ready->Remove();
+    current->numReady--;
+    numInQueue--;
+    slotsLeft--;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// GangRunQueue::Mapcar
+//	Apply "func" to every ready thread: those of the current gang,
+//	then those of the waiting gangs in the order they will run.
+//----------------------------------------------------------------------
+
+void
+GangRunQueue::Mapcar(VoidFunctionPtr func)
+{
+    if (current != NULL)
+	current->ready->Mapcar(func);
+    for (ListElement *e = gangList->first; e != NULL; e = e->next)
+	((Gang *)e->item)->ready->Mapcar(func);
+}
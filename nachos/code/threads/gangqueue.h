@@ -0,0 +1,70 @@
+// gangqueue.h
+//	Data structures for a gang (co-scheduling) ready queue.
+//
+//	Threads are grouped into gangs by the root ancestor of their
+//	process family: a batch job and everything it forks, directly or
+//	indirectly, belong to one gang.  Gangs take turns round robin.  A
+//	gang's turn lasts as many slots as it had ready threads when the
+//	turn began, so the members of a family run back to back instead
+//	of being interleaved with unrelated jobs; a parent blocking in
+//	Join hands the CPU straight to its children.
+//
+//	Gangs are found by id through a small hash table, and are only
+//	kept while they have ready threads or hold the current turn.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef GANGQUEUE_H
+#define GANGQUEUE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+
+#define GANG_HASH_SIZE	64
+
+// The ready threads of one process family.
+
+class Gang {
+  public:
+    int id;			// pid of the family's root ancestor
+    List *ready;		// its ready threads, FIFO
+    int numReady;
+    bool queued;		// waiting for a turn on the gang list?
+    Gang *hashNext;		// next gang in the same hash bucket
+};
+
+// The following class defines a ready queue that runs the threads of
+// a gang in consecutive slots, and the gangs round robin.
+
+class GangRunQueue {
+  public:
+    GangRunQueue();			// initialize an empty queue
+    ~GangRunQueue();			// de-allocate the queue
+
+    void Insert(NachOSThread *thread, int gangId);
+					// Put thread at the tail of gang
+					// "gangId"
+    NachOSThread *RemoveNext();		// Take the next thread off, NULL
+					// if none; may start a new turn
+
+    bool IsEmpty() { return (numInQueue == 0); }
+    int NumInQueue() { return numInQueue; }
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every thread,
+					// current gang first
+
+  private:
+    Gang *Lookup(int id, bool create);	// Find a gang, or make it
+    void EndTurn();			// The current gang's turn is over
+
+    Gang *table[GANG_HASH_SIZE];	// gangs, hashed by id
+    List *gangList;			// gangs waiting for a turn, FIFO
+    Gang *current;			// gang whose turn it is, or NULL
+    int slotsLeft;			// slots left in its turn
+    int numInQueue;
+};
+
+#endif // GANGQUEUE_H
@@ -0,0 +1,172 @@
+// heap.cc
+//	Routines to manage a binary min-heap of "things".
+//
+//	The heap is kept in an array, with the children of slot i at
+//	slots 2i+1 and 2i+2.  The array is doubled when it fills up.
+//
+//	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "heap.h"
+
+#define INITIAL_HEAP_SIZE 16
+
+//----------------------------------------------------------------------
+// Heap::Heap
+//	Initialize a heap, empty to start with.
+//----------------------------------------------------------------------
+
+Heap::Heap()
+{
+    size = INITIAL_HEAP_SIZE;
+    elements = new HeapElement[size];
+    numInHeap = 0;
+    nextSeq = 0;
+}
+
+//----------------------------------------------------------------------
+// Heap::~Heap
+//	De-allocate the heap.  As with List, the items themselves are
+//	not de-allocated.
+//----------------------------------------------------------------------
+
+Heap::~Heap()
+{
+    delete [] elements;
+}
+
+//----------------------------------------------------------------------
+// Heap::Less
+//	Order slots by key, then by insertion order.  The sequence
+//	comparison is written as a difference so that it stays correct
+//	when nextSeq wraps around.
+//----------------------------------------------------------------------
+
+bool
+Heap::Less(int i, int j)
+{
+    if (elements[i].key != elements[j].key)
+	return (elements[i].key < elements[j].key);
+    return ((int)(elements[i].seq - elements[j].seq) < 0);
+}
+
+//----------------------------------------------------------------------
+// Heap::Swap, Heap::SiftUp, Heap::SiftDown
+//	Restore the heap property after the slot "i" has changed.
+//----------------------------------------------------------------------
+
+void
+Heap::Swap(int i, int j)
+{
+    HeapElement temp = elements[i];
+
+    elements[i] = elements[j];
+    elements[j] = temp;
+}
+
+void
+Heap::SiftUp(int i)
+{
+    while (i > 0 && Less(i, (i - 1) / 2)) {
+	Swap(i, (i - 1) / 2);
+	i = (i - 1) / 2;
+    }
+}
+
+void
+Heap::SiftDown(int i)
+{
+    int child;
+
+    for (;;) {
+	child = 2 * i + 1;
+	if (child >= numInHeap)
+	    return;
+	if (child + 1 < numInHeap && Less(child + 1, child))
+	    child++;
+	if (!Less(child, i))
+	    return;
+	Swap(i, child);
+	i = child;
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap::Insert
+//	Put "item" into the heap with key "key".
+//----------------------------------------------------------------------
+
+void
+Heap::Insert(void *item, double key)
+{
+    if (numInHeap == size) {
+	HeapElement *bigger = new HeapElement[size * 2];
+	for (int i = 0; i < numInHeap; i++)
+	    bigger[i] = elements[i];
+	delete [] elements;
+	elements = bigger;
+	size *= 2;
+    }
+    elements[numInHeap].item = item;
+    elements[numInHeap].key = key;
+    elements[numInHeap].seq = nextSeq++;
+    numInHeap++;
+    SiftUp(numInHeap - 1);
+}
+
+//----------------------------------------------------------------------
+// Heap::Min
+//	Return the item with the smallest key, without removing it.
+//	NULL if the heap is empty.  If "keyPtr" is not NULL, the key
+//	of the item is stored there.
+//----------------------------------------------------------------------
+
+void *
+Heap::Min(double *keyPtr)
+{
+    if (IsEmpty())
+	return NULL;
+    if (keyPtr != NULL)
+	*keyPtr = elements[0].key;
+    return elements[0].item;
+}
+
+//----------------------------------------------------------------------
+// Heap::RemoveMin
+//	Remove the item with the smallest key from the heap.
+//
+// Returns:
+//	Pointer to removed item, NULL if the heap is empty.
+//	Sets *keyPtr (if not NULL) to the key of the removed item.
+//----------------------------------------------------------------------
+
+void *
+Heap::RemoveMin(double *keyPtr)
+{
+    void *thing = Min(keyPtr);
+
+    if (thing == NULL)
+	return NULL;
+    numInHeap--;
+    if (numInHeap > 0) {
+	elements[0] = elements[numInHeap];
+	SiftDown(0);
+    }
+    return thing;
+}
+
+//----------------------------------------------------------------------
+// Heap::Mapcar
+//	Apply a function to each item in the heap, in array order.
+//----------------------------------------------------------------------
+
+void
+Heap::Mapcar(VoidFunctionPtr func)
+{
+    for (int i = 0; i < numInHeap; i++)
+	(*func)((int)elements[i].item);
+}
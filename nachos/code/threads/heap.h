@@ -0,0 +1,62 @@
+// heap.h
+//	Data structures for a binary min-heap ("priority queue").
+//
+//	Like a List, a Heap can hold any type of item ("void *").  Each
+//	item carries a floating-point key; the item with the smallest key
+//	comes out first.  Items with equal keys come out in the order they
+//	were inserted, so the heap can stand in for a sorted List without
+//	changing FIFO behavior on ties.
+//
+//	Insert and RemoveMin are O(log n); Min is O(1).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// One slot in the heap array.  "seq" breaks ties between equal keys.
+
+class HeapElement {
+  public:
+    void *item;			// pointer to item in the heap
+    double key;			// sort key, smallest first
+    unsigned seq;		// insertion order, for FIFO ties
+};
+
+// The following class defines a heap of items, ordered by key.
+// The array grows as needed.
+
+class Heap {
+  public:
+    Heap();			// initialize an empty heap
+    ~Heap();			// de-allocate the heap (not the items)
+
+    void Insert(void *item, double key);	// Put item into heap
+    void *RemoveMin(double *keyPtr);	// Remove smallest item, NULL if
+					// empty; its key goes to *keyPtr
+    void *Min(double *keyPtr);		// Same, without removing it
+
+    bool IsEmpty() { return (numInHeap == 0); }
+    int NumInHeap() { return numInHeap; }
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every item,
+					// in heap (not sorted) order
+
+  private:
+    bool Less(int i, int j);		// Does slot i come before slot j?
+    void Swap(int i, int j);
+    void SiftUp(int i);
+    void SiftDown(int i);
+
+    HeapElement *elements;		// elements[0] is the smallest
+    int numInHeap;
+    int size;				// allocated length of elements
+    unsigned nextSeq;			// sequence number of next Insert
+};
+
+#endif // HEAP_H
@@ -8,21 +8,50 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
+// Usage: nachos -d <debugflags> -rs <random seed #> -alpha <a | adaptive>
+//		-aging <rate> -ts <dispatch table file> -trace <trace file>
+//		-stacks <free stacks kept>
+//		-R <trace file> <schedulerCode> [quantum]
 //		-s -x <nachos file> -c <consoleIn> <consoleOut>
+//		-C <nachos file> [copies]
 //		-f -cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
+//              -B -T
 //              -n <network reliability> -m <machine id>
 //              -o <other machine id>
 //              -z
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -alpha sets the SJF/SRTF burst estimator's smoothing factor, or
+//	makes each thread tune its own
+//    -aging makes waiting threads gain priority under SJF and UNIX
+//	scheduling: "rate" ticks of predicted burst, or priority levels,
+//	per tick on the ready queue (0, the default, turns aging off)
+//    -ts reads the time-sharing scheduler's dispatch table from the given
+//	file instead of "dispatch_table"
+//    -trace writes when each job arrives, and the CPU bursts and blocked
+//	times it has, to the given file
+//    -stacks sets how many stacks of destroyed threads are kept for new
+//	threads, saving the host calls that set up their guard pages
+//	(default 16; 0 frees every stack)
 //    -z prints the copyright message
 //
+//  THREADS
+//    -B benchmarks the UNIX scheduler's ready queue, and the scheduler's
+//	work per context switch under every policy
+//    -T runs the self-tests of the scheduling policies, and of the pid
+//	and child tables
+//    -R replays a trace written by -trace under the given scheduling
+//	policy and timer quantum (default: the policy's own), on one CPU,
+//	and prints its waiting times without running any user code
+//
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
+//    -ncpu simulates a multiprocessor with the given number of CPUs
 //    -x runs a user program
+//    -C calibrates the round robin quanta on copies of a user program,
+//	and saves them for batch files to use by name
 //    -c tests the console
 //
 //  FILESYS
@@ -60,7 +89,11 @@ extern void ThreadTest(void), Copy(char *unixFile, char *nachosFile);
 extern void Print(char *file), PerformanceTest(void);
 extern void StartUserProcess(char *file), ConsoleTest(char *in, char *out);
 extern void MailTest(int networkID);
+extern void ReadyQueueBenchmark(void), SchedulerSwitchBenchmark(void);
+extern void SelfTest(void);
+extern void CalibrateQuanta(char *file, int copies);
 extern void ExecFileCommands(char *filename);
+extern void ReplayTrace(char *fileName, int code, int quantum);
 
 //----------------------------------------------------------------------
 // main
@@ -93,6 +126,23 @@ main(int argc, char **argv)
 	argCount = 1;
         if (!strcmp(*argv, "-z"))               // print copyright
             printf (copyright);
+#ifdef THREADS
+        if (!strcmp(*argv, "-B")) {             // scheduler benchmarks
+            ReadyQueueBenchmark();
+            SchedulerSwitchBenchmark();
+        } else if (!strcmp(*argv, "-T")) {      // self-tests
+            SelfTest();
+        } else if (!strcmp(*argv, "-R")) {      // replay a burst trace
+            ASSERT(argc > 2);
+            if (argc > 3 && atoi(*(argv + 3)) > 0) {
+                ReplayTrace(*(argv + 1), atoi(*(argv + 2)), atoi(*(argv + 3)));
+                argCount = 4;
+            } else {
+                ReplayTrace(*(argv + 1), atoi(*(argv + 2)), 0);
+                argCount = 3;
+            }
+        }
+#endif // THREADS
 #ifdef USER_PROGRAM
         if (!strcmp(*argv, "-x")) {        	// run a user program
 	    	ASSERT(argc > 1);
@@ -104,6 +154,16 @@ main(int argc, char **argv)
             ExecFileCommands(*(argv + 1));
             argCount = 2;
         }
+        else if (!strcmp(*argv, "-C")) {        	// calibrate the quanta
+	    ASSERT(argc > 1);
+	    if (argc > 2 && atoi(*(argv + 2)) > 0) {
+		CalibrateQuanta(*(argv + 1), atoi(*(argv + 2)));
+		argCount = 3;
+	    } else {
+		CalibrateQuanta(*(argv + 1), CALIBRATION_COPIES);
+		argCount = 2;
+	    }
+        }
         else if (!strcmp(*argv, "-c")) {      // test the console
 	    if (argc == 1)
 	        ConsoleTest(NULL, NULL);
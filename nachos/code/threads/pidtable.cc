@@ -0,0 +1,173 @@
+// pidtable.cc
+//	Routines to hand out, look up and reuse process ids.  See
+//	pidtable.h.  Every operation takes constant time, but for the
+//	occasional doubling of the table.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "pidtable.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// PidTable::PidTable
+//	An empty table: the first pid handed out is 0.
+//----------------------------------------------------------------------
+
+PidTable::PidTable()
+{
+    size = PID_TABLE_MIN_SIZE;
+    threads = new NachOSThread*[size];
+    state = new PidState[size];
+    nextFree = new int[size];
+    numUsed = 0;
+    freeHead = freeTail = -1;
+    numLive = 0;
+    exitWaiters = new List;
+}
+
+PidTable::~PidTable()
+{
+    delete [] threads;
+    delete [] state;
+    delete [] nextFree;
+    delete exitWaiters;
+}
+
+//----------------------------------------------------------------------
+// PidTable::Grow
+//	Double the room for pids, when all of them have been handed out
+//	and none is free.
+//----------------------------------------------------------------------
+
+void
+PidTable::Grow()
+{
+    NachOSThread **newThreads = new NachOSThread*[2 * size];
+    PidState *newState = new PidState[2 * size];
+    int *newNextFree = new int[2 * size];
+
+    for (int i = 0; i < numUsed; i++) {
+	newThreads[i] = threads[i];
+	newState[i] = state[i];
+	newNextFree[i] = nextFree[i];
+    }
+    delete [] threads;
+    delete [] state;
+    delete [] nextFree;
+    threads = newThreads;
+    state = newState;
+    nextFree = newNextFree;
+    size *= 2;
+}
+
+//----------------------------------------------------------------------
+// PidTable::Add
+//	Return the pid of the new thread "thread": the pid freed the
+//	longest ago, or else one never used.
+//----------------------------------------------------------------------
+
+int
+PidTable::Add(NachOSThread *thread)
+{
+    int pid;
+
+    if (freeHead != -1) {
+	pid = freeHead;
+	freeHead = nextFree[pid];
+	if (freeHead == -1)
+	    freeTail = -1;
+    } else {
+	if (numUsed == size)
+	    Grow();
+	pid = numUsed++;
+    }
+    threads[pid] = thread;
+    state[pid] = PID_LIVE;
+    numLive++;
+    return pid;
+}
+
+//----------------------------------------------------------------------
+// PidTable::Exited
+//	The thread with "pid" has exited, or will never be waited for
+//	(the idle threads).  It no longer counts as live; the pid cannot
+//	be reused until it is freed.  Whoever waits for a thread to exit
+//	is woken, to look at NumLive again.
+//----------------------------------------------------------------------
+
+void
+PidTable::Exited(int pid)
+{
+    NachOSThread *waiter;
+    IntStatus oldLevel;
+
+    ASSERT(pid >= 0 && pid < numUsed && state[pid] == PID_LIVE);
+    state[pid] = PID_EXITED;
+    threads[pid] = NULL;
+    numLive--;
+
+    if (exitWaiters->IsEmpty())
+	return;
+    oldLevel = interrupt->SetLevel(IntOff);
+    while ((waiter = (NachOSThread *)exitWaiters->Remove()) != NULL)
+	scheduler->ThreadIsReadyToRun(waiter);
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// PidTable::WaitForExit
+//	Put the current thread to sleep until some live thread exits.  The
+//	caller checks NumLive again when it wakes, as after a condition
+//	variable's Wait.
+//----------------------------------------------------------------------
+
+void
+PidTable::WaitForExit()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    exitWaiters->Append((void *)currentThread);
+    currentThread->PutThreadToSleep();
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// PidTable::Free
+//	Let "pid" be reused, once no one can Join with its thread.  A
+//	live pid is first marked exited, for threads that are destroyed
+//	without ever running.  Pid 0 stays reserved.
+//----------------------------------------------------------------------
+
+void
+PidTable::Free(int pid)
+{
+    ASSERT(pid >= 0 && pid < numUsed);
+    if (state[pid] == PID_LIVE)
+	Exited(pid);
+    ASSERT(state[pid] == PID_EXITED);
+    if (pid == 0)
+	return;
+    state[pid] = PID_FREE;
+    nextFree[pid] = -1;
+    if (freeTail == -1)
+	freeHead = pid;
+    else
+	nextFree[freeTail] = pid;
+    freeTail = pid;
+}
+
+//----------------------------------------------------------------------
+// PidTable::Lookup
+//	Return the thread with pid "pid", or NULL if "pid" is not live.
+//----------------------------------------------------------------------
+
+NachOSThread *
+PidTable::Lookup(int pid)
+{
+    if (pid < 0 || pid >= numUsed || state[pid] != PID_LIVE)
+	return NULL;
+    return threads[pid];
+}
@@ -0,0 +1,65 @@
+// pidtable.h
+//	Data structures for handing out process ids, and for finding the
+//	thread that has a given pid.
+//
+//	The table grows as needed, so there is no limit on the number of
+//	threads, and the pid of a thread that is gone is reused.  A pid
+//	passes through three states:
+//
+//		live	  its thread has not exited
+//		exited	  its thread has exited, but the pid is still
+//			  reserved: its parent may yet Join with it
+//		free	  it can be handed out again
+//
+//	The table counts the live threads, so that an exiting thread can
+//	tell whether it is the last one without looking at every pid, and
+//	wakes the threads waiting for that count to drop.
+//	Pid 0, the main thread's, is never reused: statistics leave it out.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PIDTABLE_H
+#define PIDTABLE_H
+
+#include "copyright.h"
+#include "list.h"
+
+#define PID_TABLE_MIN_SIZE	128	// room for pids at the start
+
+class NachOSThread;
+
+enum PidState { PID_FREE, PID_LIVE, PID_EXITED };
+
+// The following class defines the table of all pids.  Freed pids are
+// kept in a FIFO, so that the least recently used one is reused first.
+
+class PidTable {
+  public:
+    PidTable();
+    ~PidTable();
+
+    int Add(NachOSThread *thread);	// give a new thread a pid
+    void Exited(int pid);		// its thread has exited, but the pid
+					// stays reserved
+    void Free(int pid);			// the pid can be reused
+    NachOSThread *Lookup(int pid);	// the thread with a live pid, NULL if
+					// "pid" is not live
+    int NumLive() { return numLive; }	// threads that have not exited
+    void WaitForExit();			// sleep until a live thread exits
+
+  private:
+    void Grow();			// double the room for pids
+
+    NachOSThread **threads;		// the thread of each live pid
+    PidState *state;			// the state of each pid
+    int *nextFree;			// next pid in the FIFO of free ones
+    int size;				// room in the arrays
+    int numUsed;			// pids handed out at least once
+    int freeHead, freeTail;		// the free pids, -1 if none
+    int numLive;
+    List *exitWaiters;			// threads sleeping in WaitForExit
+};
+
+#endif // PIDTABLE_H
@@ -0,0 +1,2028 @@
+// policy.cc
+//	Routines of the scheduling policies: how each one queues ready
+//	threads, picks the next one to run, and keeps its bookkeeping.
+//
+// 	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "policy.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::SchedulingPolicy
+// 	Initialize a policy deciding for "sched", which programs the timer
+//	to interrupt every "period" ticks.
+//----------------------------------------------------------------------
+
+SchedulingPolicy::SchedulingPolicy(NachOSscheduler *sched, int period)
+{
+    owner = sched;
+    timerPeriod = period;
+    preemptPending = false;
+    outer = NULL;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::StateOf
+// 	Return our record of "thread".  A thread we have not seen yet --
+//	the main thread, a new batch job, or one that ran under a policy
+//	of another kind before a switch -- is admitted now, and the record
+//	of the other kind thrown away.  Within a fair-share group, the
+//	record is kept in the group's record of the thread.
+//----------------------------------------------------------------------
+
+SchedState *
+SchedulingPolicy::StateOf(NachOSThread *thread)
+{
+    SchedState **slot = &thread->schedState;
+
+    if (outer != NULL)
+        slot = &((GroupState *)outer->StateOf(thread))->inner;
+    if (*slot == NULL || (*slot)->kind != stateKind) {
+        delete *slot;
+        *slot = Admit(thread);
+    }
+    return *slot;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::ForkState
+// 	Return the record a child of "parent" starts with, NULL to have it
+//	admitted afresh when it is first made ready.
+//----------------------------------------------------------------------
+
+SchedState *
+SchedulingPolicy::ForkState(NachOSThread *parent)
+{
+    return StateOf(parent)->Fork();
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::PreemptPending
+// 	Return TRUE, once, if ThreadReady found that the thread it queued
+//	should run before the running thread.
+//----------------------------------------------------------------------
+
+bool
+SchedulingPolicy::PreemptPending()
+{
+    if (!preemptPending)
+        return false;
+    preemptPending = false;
+    return true;
+}
+
+//----------------------------------------------------------------------
+// NewSchedulingPolicy
+// 	Return a new policy for schedulerCode "code", deciding for
+//	"owner".  Round robin and UNIX come in four quanta each; codes
+//	above the known ones are round robin with the default period.
+//----------------------------------------------------------------------
+
+SchedulingPolicy *
+NewSchedulingPolicy(NachOSscheduler *owner, int code)
+{
+    switch (code) {
+      case 2:
+	return new SJFPolicy(owner);
+      case 3:
+	return new RoundRobinPolicy(owner, 30);
+      case 4:
+	return new RoundRobinPolicy(owner, 60);
+      case 5:
+	return new RoundRobinPolicy(owner, 90);
+      case 6:
+	return new RoundRobinPolicy(owner, 30);
+      case 7:
+	return new UnixPolicy(owner, 40);
+      case 8:
+	return new UnixPolicy(owner, 70);
+      case 9:
+	return new UnixPolicy(owner, 90);
+      case 10:
+	return new UnixPolicy(owner, 40);
+      case 11:
+	return new MLFQPolicy(owner);
+      case 12:
+	return new StridePolicy(owner);
+      case 13:
+	return new CFSPolicy(owner);
+      case 14:
+	return new SRTFPolicy(owner);
+      case 15:
+	return new EDFPolicy(owner);
+      case 16:
+	return new GangPolicy(owner);
+      case 17:
+	return new TSPolicy(owner);
+      case 18:
+	return new VirtualRoundRobinPolicy(owner, VRR_QUANTUM);
+      case 19:
+	return new DynamicRoundRobinPolicy(owner);
+      default:
+	if (code >= 3)
+	    return new RoundRobinPolicy(owner, DEFAULT_TIMER_PERIOD);
+	return new FCFSPolicy(owner);
+    }
+}
+
+//----------------------------------------------------------------------
+// FCFSPolicy, RoundRobinPolicy
+// 	A FIFO of ready threads.  Round robin only differs in preempting
+//	on every timer interrupt.
+//----------------------------------------------------------------------
+
+FCFSPolicy::FCFSPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, DEFAULT_TIMER_PERIOD)
+{
+    readyList = new List;
+    stateKind = FCFS_STATE;
+}
+
+FCFSState::FCFSState(SchedStateKind stateKind)
+    : SchedState(stateKind)
+{
+    ioBurst = 0;
+}
+
+SchedState *
+FCFSPolicy::Admit(NachOSThread *thread)
+{
+    return new FCFSState(FCFS_STATE);
+}
+
+FCFSPolicy::~FCFSPolicy()
+{
+    delete readyList;
+}
+
+void
+FCFSPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    readyList->Append((void *)thread);
+}
+
+NachOSThread *
+FCFSPolicy::PickNext()
+{
+    return (NachOSThread *)readyList->Remove();
+}
+
+//----------------------------------------------------------------------
+// FCFSPolicy::BurstEnded
+// 	Add up the bursts of a thread until it blocks, which gives the CPU
+//	burst between blocking calls whatever the preemptions, for quantum
+//	calibration (see CalibrateQuanta).
+//----------------------------------------------------------------------
+
+void
+FCFSPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    FCFSState *state = State(thread);
+
+    state->ioBurst += burst;
+    if (thread->getStatus() == BLOCKED) {
+        if (state->ioBurst > 0 && thread->GetPID() > 0)
+            stats->RecordIOBurst(state->ioBurst);
+        state->ioBurst = 0;
+    }
+}
+
+void
+FCFSPolicy::Print()
+{
+    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+RoundRobinPolicy::RoundRobinPolicy(NachOSscheduler *sched, int quantum)
+    : FCFSPolicy(sched)
+{
+    timerPeriod = quantum;
+}
+
+//----------------------------------------------------------------------
+// VirtualRoundRobinPolicy::VirtualRoundRobinPolicy
+// 	The main FIFO is round robin's; threads back from I/O with part
+//	of their quantum left wait on the auxiliary one.
+//----------------------------------------------------------------------
+
+VirtualRoundRobinPolicy::VirtualRoundRobinPolicy(NachOSscheduler *sched,
+						 int quantum)
+    : RoundRobinPolicy(sched, quantum)
+{
+    auxList = new List;
+    stateKind = VRR_STATE;
+}
+
+VRRState::VRRState()
+    : FCFSState(VRR_STATE)
+{
+    left = 0;
+}
+
+SchedState *
+VirtualRoundRobinPolicy::Admit(NachOSThread *thread)
+{
+    return new VRRState;
+}
+
+VirtualRoundRobinPolicy::~VirtualRoundRobinPolicy()
+{
+    delete auxList;
+}
+
+void
+VirtualRoundRobinPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    if (oldStatus == BLOCKED && State(thread)->left > 0)
+        auxList->Append((void *)thread);
+    else
+        readyList->Append((void *)thread);
+}
+
+NachOSThread *
+VirtualRoundRobinPolicy::PickNext()
+{
+    if (!auxList->IsEmpty())
+        return (NachOSThread *)auxList->Remove();
+    return (NachOSThread *)readyList->Remove();
+}
+
+//----------------------------------------------------------------------
+// VirtualRoundRobinPolicy::BurstEnded
+// 	A thread that blocks keeps what is left of its slice; one that is
+//	preempted or yields has had its turn.
+//----------------------------------------------------------------------
+
+void
+VirtualRoundRobinPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    int left = Slice(thread) - burst;
+
+    RoundRobinPolicy::BurstEnded(thread, burst);
+    if (thread->getStatus() == BLOCKED && left > 0)
+        State(thread)->left = left;
+    else
+        State(thread)->left = 0;
+}
+
+int
+VirtualRoundRobinPolicy::Dispatched(NachOSThread *thread)
+{
+    return Slice(thread);
+}
+
+void
+VirtualRoundRobinPolicy::Print()
+{
+    auxList->Mapcar((VoidFunctionPtr) ThreadPrint);
+    readyList->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// VirtualRoundRobinPolicy::Slice
+// 	Return how long "thread" may run when next dispatched: the rest of
+//	its quantum if it comes from the auxiliary FIFO, else the quantum
+//	the timer is programmed with.
+//----------------------------------------------------------------------
+
+int
+VirtualRoundRobinPolicy::Slice(NachOSThread *thread)
+{
+    int quantum = timerPeriod;
+    int left = State(thread)->left;
+
+    if (left > 0 && left < quantum)
+        return left;
+    return quantum;
+}
+
+//----------------------------------------------------------------------
+// DynamicRoundRobinPolicy::DynamicRoundRobinPolicy
+// 	Round robin's FIFO, with the timer running at the smallest slice
+//	until the first dispatch reprograms it.
+//----------------------------------------------------------------------
+
+DynamicRoundRobinPolicy::DynamicRoundRobinPolicy(NachOSscheduler *sched)
+    : RoundRobinPolicy(sched, DRR_MIN_GRANULARITY)
+{
+}
+
+bool
+DynamicRoundRobinPolicy::Tick(NachOSThread *thread)
+{
+    int burst = stats->totalTicks - thread->curr_cpu_burst_start;
+
+    return (burst >= Slice());
+}
+
+//----------------------------------------------------------------------
+// DynamicRoundRobinPolicy::Slice
+// 	Return the target latency shared among the runnable threads: the
+//	ready ones, which the scheduler counts, and the running one.
+//----------------------------------------------------------------------
+
+int
+DynamicRoundRobinPolicy::Slice()
+{
+    int slice = DRR_TARGET_LATENCY / (owner->NumReady() + 1);
+
+    if (slice < DRR_MIN_GRANULARITY)
+        slice = DRR_MIN_GRANULARITY;
+    return slice;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictingPolicy::BurstPredictingPolicy
+// 	Ready threads are kept in a heap keyed by their predicted burst.
+//----------------------------------------------------------------------
+
+BurstPredictingPolicy::BurstPredictingPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, DEFAULT_TIMER_PERIOD)
+{
+    burstHeap = new Heap;
+    stateKind = BURST_STATE;
+}
+
+BurstState::BurstState()
+    : SchedState(BURST_STATE)
+{
+    estimate = 0.0;
+    burstDone = 0;
+    alpha = -1.0;
+    alphaGrad = 0.0;
+    predictionCount = 0;
+    absError = relError = 0.0;
+}
+
+SchedState *
+BurstState::Fork()
+{
+    BurstState *child = new BurstState;
+
+    child->estimate = estimate;
+    return child;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictingPolicy::Admit
+// 	A new thread's first burst is predicted from what earlier runs of
+//	its executable taught the burst history, if anything.
+//----------------------------------------------------------------------
+
+SchedState *
+BurstPredictingPolicy::Admit(NachOSThread *thread)
+{
+    BurstState *state = new BurstState;
+
+    if (burstHistory != NULL)
+        state->estimate = burstHistory->ExpectedBurst(thread);
+    return state;
+}
+
+BurstPredictingPolicy::~BurstPredictingPolicy()
+{
+    delete burstHeap;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictingPolicy::PredictBurst
+// 	Called when a CPU burst of "thread" that was predicted to take
+//	"predicted" ticks turned out to take "burst" ticks.  Record the
+//	error, and return the prediction for the next burst, the
+//	exponential average alpha * burst + (1 - alpha) * predicted.
+//
+//	In adaptive mode the thread uses its own alpha.  The last
+//	prediction changed with alpha at the rate alphaGrad (the error of
+//	the burst before), so stepping alpha by error * grad goes down the
+//	gradient of the squared error.
+//----------------------------------------------------------------------
+
+double
+BurstPredictingPolicy::PredictBurst(NachOSThread *thread, int burst, double predicted)
+{
+    BurstState *state = State(thread);
+    double error = burst - predicted;
+    double a = owner->alpha;
+
+    stats->RecordBurstError(burst, predicted);
+    state->predictionCount++;
+    state->absError += (error < 0) ? -error : error;
+    state->relError += ((error < 0) ? -error : error) / burst;
+
+    if (owner->adaptiveAlpha) {
+        double grad = state->alphaGrad;
+
+        if (state->alpha < 0)
+            state->alpha = owner->alpha;
+        state->alpha += ALPHA_STEP * error * grad / (grad * grad + 1);
+        if (state->alpha < ALPHA_MIN)
+            state->alpha = ALPHA_MIN;
+        if (state->alpha > ALPHA_MAX)
+            state->alpha = ALPHA_MAX;
+        state->alphaGrad = error;
+        a = state->alpha;
+    }
+    return a * burst + (1 - a) * predicted;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictingPolicy::ThreadExited
+// 	Hand the accuracy of the thread's predictions to the statistics,
+//	and the estimate it finished with to the burst history.
+//----------------------------------------------------------------------
+
+void
+BurstPredictingPolicy::ThreadExited(NachOSThread *thread)
+{
+    BurstState *state = State(thread);
+
+    if (state->predictionCount == 0)
+        return;
+    if (thread->GetPID() > 0)
+        stats->RecordPrediction(thread->GetPID(), state->predictionCount,
+                state->absError, state->relError,
+                (state->alpha < 0) ? owner->alpha : state->alpha);
+    if (burstHistory != NULL)
+        burstHistory->Learn(thread, state->estimate);
+}
+
+void
+BurstPredictingPolicy::Print()
+{
+    burstHeap->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// SJFPolicy::ThreadReady
+// 	After a non-zero CPU burst, report the error and update the
+//	prediction; then queue the thread by its exact expected burst,
+//	aged from the time it is queued (see policy.h).
+//----------------------------------------------------------------------
+
+void
+SJFPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    BurstState *state = State(thread);
+
+    if (thread->prev_cpu_burst > 0)
+        state->estimate = PredictBurst(thread, thread->prev_cpu_burst,
+                state->estimate);
+    burstHeap->Insert((void *)thread, state->estimate
+            + owner->agingRate * thread->curr_wait_start);
+}
+
+NachOSThread *
+SJFPolicy::PickNext()
+{
+    return (NachOSThread *)burstHeap->RemoveMin(NULL);
+}
+
+//----------------------------------------------------------------------
+// SRTFPolicy
+// 	Shortest remaining time first.  A thread that becomes ready with
+//	less work left than the running thread asks to preempt it; the
+//	request is acted on by the next timer interrupt, or straight away
+//	by system calls that make a thread ready, like fork.
+//----------------------------------------------------------------------
+
+SRTFPolicy::SRTFPolicy(NachOSscheduler *sched)
+    : BurstPredictingPolicy(sched)
+{
+}
+
+void
+SRTFPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    double remaining = RemainingBurst(thread);
+
+    burstHeap->Insert((void *)thread, remaining);
+    if (oldStatus != RUNNING && currentThread != NULL && currentThread != thread
+            && currentThread->getStatus() == RUNNING
+            && remaining < RemainingBurst(currentThread))
+        preemptPending = true;
+}
+
+NachOSThread *
+SRTFPolicy::PickNext()
+{
+    preemptPending = false;     // whoever runs next was chosen afresh
+    return (NachOSThread *)burstHeap->RemoveMin(NULL);
+}
+
+//----------------------------------------------------------------------
+// SRTFPolicy::BurstEnded
+// 	The bursts of a thread are added up until it blocks, which gives
+//	the CPU burst between blocking calls whatever the preemptions; that
+//	whole burst is folded into the estimate.
+//----------------------------------------------------------------------
+
+void
+SRTFPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    BurstState *state = State(thread);
+
+    state->burstDone += burst;
+    if (thread->getStatus() == BLOCKED) {
+        if (state->burstDone > 0)
+            state->estimate = PredictBurst(thread, state->burstDone,
+                    state->estimate);
+        state->burstDone = 0;
+    }
+}
+
+bool
+SRTFPolicy::PreemptPending()
+{
+    if (!SchedulingPolicy::PreemptPending())
+        return false;
+    stats->srtf_preemptions++;
+    return true;
+}
+
+//----------------------------------------------------------------------
+// SRTFPolicy::RemainingBurst
+// 	Return the predicted rest of "thread"'s current CPU burst, counting
+//	the time it has been running if it is the running thread.
+//----------------------------------------------------------------------
+
+double
+SRTFPolicy::RemainingBurst(NachOSThread *thread)
+{
+    BurstState *state = State(thread);
+    double remaining = state->estimate - state->burstDone;
+
+    if (thread->getStatus() == RUNNING)
+        remaining -= stats->totalTicks - thread->curr_cpu_burst_start;
+    if (remaining < 0)
+        remaining = 0;
+    return remaining;
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::UnixPolicy
+// 	Ready threads are kept in a PriorityRunQueue, and those whose
+//	priority still decays on a decay list.
+//----------------------------------------------------------------------
+
+UnixPolicy::UnixPolicy(NachOSscheduler *sched, int quantum)
+    : SchedulingPolicy(sched, quantum)
+{
+    priorityQueue = new PriorityRunQueue;
+    decayEpoch = 0;
+    decayList = NULL;
+    ageHead = ageTail = NULL;
+    stateKind = UNIX_STATE;
+}
+
+UnixPolicy::~UnixPolicy()
+{
+    delete priorityQueue;
+}
+
+UnixState::UnixState(int base, int epoch)
+    : SchedState(UNIX_STATE)
+{
+    basePriority = priority = base;
+    cpuCount = 0;
+    cpuEpoch = epoch;
+    decayNext = decayPrev = NULL;
+    onDecayList = false;
+    ageNext = agePrev = NULL;
+}
+
+SchedState *
+UnixPolicy::Admit(NachOSThread *thread)
+{
+    return new UnixState(UNIX_BASE_PRIORITY + thread->batchPriority,
+            decayEpoch);
+}
+
+void
+UnixPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    UnixState *state;
+
+    UpdatePriority(thread);
+    state = State(thread);
+    priorityQueue->Insert(thread, &state->link, state->priority);
+    if (state->cpuCount > 0)
+        AddToDecayList(thread);
+    // A thread waking up with a better priority than the running
+    // thread's (as of its last update) should not wait for the quantum
+    if (oldStatus == BLOCKED && currentThread != NULL
+            && currentThread != thread
+            && currentThread->getStatus() == RUNNING
+            && state->priority < State(currentThread)->priority)
+        preemptPending = true;
+    if (owner->agingRate > 0) {
+        state->ageNext = NULL;
+        state->agePrev = ageTail;
+        if (ageTail != NULL)
+            State(ageTail)->ageNext = thread;
+        else
+            ageHead = thread;
+        ageTail = thread;
+    }
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::PickNext
+// 	Take the first thread on the best non-empty priority level -- or,
+//	with aging, the longest waiting thread if it has aged past it.
+//----------------------------------------------------------------------
+
+NachOSThread *
+UnixPolicy::PickNext()
+{
+    NachOSThread *thread;
+
+    preemptPending = false;
+    if (ageHead == NULL)
+        thread = priorityQueue->RemoveMin();
+    else {
+        thread = priorityQueue->Min();
+        if (ageHead != thread
+                && EffectivePriority(ageHead) < EffectivePriority(thread))
+            thread = ageHead;
+        priorityQueue->Remove(&State(thread)->link);
+        RemoveFromAgeList(thread);
+    }
+    if (thread != NULL && State(thread)->onDecayList)
+        RemoveFromDecayList(thread);
+    return thread;
+}
+
+void
+UnixPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    if (burst > 0)
+        ChargeCPU(thread, burst);
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::Migrated
+// 	Bring the thread's priority up to date with the decay epochs of
+//	the queue it came from, then start counting ours.
+//----------------------------------------------------------------------
+
+void
+UnixPolicy::Migrated(NachOSThread *thread, SchedulingPolicy *from)
+{
+    ((UnixPolicy *)from)->UpdatePriority(thread);
+    State(thread)->cpuEpoch = decayEpoch;
+}
+
+void
+UnixPolicy::Print()
+{
+    priorityQueue->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::ChargeCPU
+// 	Called when a non-zero CPU burst of "thread" ends.  The burst is
+//	added to the thread's CPU usage, and then every thread's usage is
+//	halved and its priority recomputed as basePriority + cpuCount/2.
+//
+//	The halving is not done to every thread here.  Instead a decay
+//	epoch is started, and a thread catches up with the epochs it has
+//	missed when it is next enqueued or inspected (UpdatePriority).
+//	Halving k times is the same as shifting right by k, so this gives
+//	exactly the priorities of the eager loop.  Only ready threads with
+//	non-zero usage must be caught up now, since they are sorted by
+//	priority; a thread leaves that set after a few epochs, once its
+//	usage has decayed to zero.  So the cost per switch no longer
+//	depends on how many threads exist.
+//
+//	"thread" is the thread whose burst just ended.
+//	"burst" is the length of that burst, in ticks.
+//----------------------------------------------------------------------
+
+void
+UnixPolicy::ChargeCPU(NachOSThread *thread, int burst)
+{
+    NachOSThread *ptr, *next;
+
+    UpdatePriority(thread);
+    State(thread)->cpuCount += burst;
+    decayEpoch++;
+    UpdatePriority(thread);
+
+    for (ptr = decayList; ptr != NULL; ptr = next) {
+        next = State(ptr)->decayNext;
+        UpdatePriority(ptr);
+        if (State(ptr)->cpuCount == 0)
+            RemoveFromDecayList(ptr);
+    }
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::UpdatePriority
+// 	Bring a thread's CPU usage and priority up to date with the
+//	current decay epoch.
+//----------------------------------------------------------------------
+
+void
+UnixPolicy::UpdatePriority(NachOSThread *thread)
+{
+    UnixState *state = State(thread);
+    int missed = decayEpoch - state->cpuEpoch;
+
+    if (missed > 0) {
+        if (missed >= 31)
+            state->cpuCount = 0;
+        else
+            state->cpuCount >>= missed;
+        state->cpuEpoch = decayEpoch;
+    }
+    SetPriority(thread, state->basePriority + state->cpuCount / 2);
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::AddToDecayList, RemoveFromDecayList
+// 	Link a ready thread with non-zero CPU usage onto (or off) the
+//	list of threads that ChargeCPU must catch up on every epoch.
+//----------------------------------------------------------------------
+
+void
+UnixPolicy::AddToDecayList(NachOSThread *thread)
+{
+    UnixState *state = State(thread);
+
+    if (state->onDecayList)
+        return;
+    state->decayPrev = NULL;
+    state->decayNext = decayList;
+    if (decayList != NULL)
+        State(decayList)->decayPrev = thread;
+    decayList = thread;
+    state->onDecayList = true;
+}
+
+void
+UnixPolicy::RemoveFromDecayList(NachOSThread *thread)
+{
+    UnixState *state = State(thread);
+
+    if (state->decayPrev == NULL)
+        decayList = state->decayNext;
+    else
+        State(state->decayPrev)->decayNext = state->decayNext;
+    if (state->decayNext != NULL)
+        State(state->decayNext)->decayPrev = state->decayPrev;
+    state->decayNext = state->decayPrev = NULL;
+    state->onDecayList = false;
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::EffectivePriority
+// 	Return the priority of a ready thread, less what it has gained by
+//	waiting.
+//----------------------------------------------------------------------
+
+double
+UnixPolicy::EffectivePriority(NachOSThread *thread)
+{
+    return State(thread)->priority
+            - owner->agingRate * (stats->totalTicks - thread->curr_wait_start);
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::RemoveFromAgeList
+// 	Unlink a thread that is leaving the ready queue from the list of
+//	ready threads by wait.
+//----------------------------------------------------------------------
+
+void
+UnixPolicy::RemoveFromAgeList(NachOSThread *thread)
+{
+    UnixState *state = State(thread);
+
+    if (state->agePrev == NULL)
+        ageHead = state->ageNext;
+    else
+        State(state->agePrev)->ageNext = state->ageNext;
+    if (state->ageNext == NULL)
+        ageTail = state->agePrev;
+    else
+        State(state->ageNext)->agePrev = state->agePrev;
+    state->ageNext = state->agePrev = NULL;
+}
+
+//----------------------------------------------------------------------
+// UnixPolicy::SetPriority
+// 	Set the priority value of a thread.  If the thread is sitting on
+//	the priority ready queue, it is moved to the tail of its new
+//	level, so the queue never holds a stale priority.
+//
+//	"thread" is the thread whose priority was recomputed.
+//	"newPriority" is its new priority value (lower is better).
+//----------------------------------------------------------------------
+
+void
+UnixPolicy::SetPriority(NachOSThread *thread, int newPriority)
+{
+    UnixState *state = State(thread);
+
+    if (state->priority == newPriority)
+        return;
+    state->priority = newPriority;
+    if (state->link.level != -1) {
+        priorityQueue->Remove(&state->link);
+        priorityQueue->Insert(thread, &state->link, newPriority);
+    }
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::MLFQPolicy
+// 	One FIFO per level.  The timer is programmed with the smallest
+//	quantum; Tick checks the quantum of the running thread's level.
+//----------------------------------------------------------------------
+
+MLFQPolicy::MLFQPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, MLFQ_BASE_QUANTUM)
+{
+    for (int i = 0; i < MLFQ_LEVELS; i++)
+        queue[i] = new List;
+    boostPeriod = 0;
+    stateKind = MLFQ_STATE;
+}
+
+MLFQPolicy::~MLFQPolicy()
+{
+    for (int i = 0; i < MLFQ_LEVELS; i++)
+        delete queue[i];
+}
+
+MLFQState::MLFQState()
+    : SchedState(MLFQ_STATE)
+{
+    level = 0;
+    boostPeriod = 0;
+}
+
+SchedState *
+MLFQPolicy::Admit(NachOSThread *thread)
+{
+    return new MLFQState;
+}
+
+void
+MLFQPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    MLFQState *state = State(thread);
+
+    // A thread missing a boost starts over at the top level
+    if (state->boostPeriod < boostPeriod) {
+        state->level = 0;
+        state->boostPeriod = boostPeriod;
+    }
+    if (thread->yieldAt && state->level < MLFQ_LEVELS - 1)
+        state->level++;             // used up its quantum: demote
+    else if (oldStatus == BLOCKED && state->level > 0)
+        state->level--;             // woke up from I/O or sleep: promote
+    queue[state->level]->Append((void *)thread);
+    if (oldStatus == BLOCKED && currentThread != NULL
+            && currentThread != thread
+            && currentThread->getStatus() == RUNNING
+            && state->level < State(currentThread)->level)
+        preemptPending = true;
+}
+
+NachOSThread *
+MLFQPolicy::PickNext()
+{
+    preemptPending = false;
+    if (stats->totalTicks / MLFQ_BOOST_PERIOD > boostPeriod)
+        Boost();
+    for (int i = 0; i < MLFQ_LEVELS; i++) {
+        if (!queue[i]->IsEmpty())
+            return (NachOSThread *)queue[i]->Remove();
+    }
+    return NULL;
+}
+
+bool
+MLFQPolicy::Tick(NachOSThread *thread)
+{
+    int burst = stats->totalTicks - thread->curr_cpu_burst_start;
+
+    return (burst >= (MLFQ_BASE_QUANTUM << State(thread)->level))
+        || PreemptPending();
+}
+
+void
+MLFQPolicy::Print()
+{
+    for (int i = 0; i < MLFQ_LEVELS; i++) {
+        printf("Level %d: ", i);
+        queue[i]->Mapcar((VoidFunctionPtr) ThreadPrint);
+        printf("\n");
+    }
+}
+
+//----------------------------------------------------------------------
+// MLFQPolicy::Boost
+// 	Anti-starvation reset: move every ready thread back to level 0,
+//	keeping the order in which they would have run.  Threads that are
+//	running or blocked now notice the new boost period, and are reset,
+//	the next time they are put on the ready list.
+//----------------------------------------------------------------------
+
+void
+MLFQPolicy::Boost()
+{
+    NachOSThread *thread;
+
+    boostPeriod = stats->totalTicks / MLFQ_BOOST_PERIOD;
+    DEBUG('t', "MLFQ boost %d at time %d\n", boostPeriod, stats->totalTicks);
+
+    for (int i = 1; i < MLFQ_LEVELS; i++) {
+        while ((thread = (NachOSThread *)queue[i]->Remove()) != NULL)
+            queue[0]->Append((void *)thread);
+    }
+    for (ListElement *ptr = queue[0]->first; ptr != NULL; ptr = ptr->next) {
+        MLFQState *state = State((NachOSThread *)ptr->item);
+
+        state->level = 0;
+        state->boostPeriod = boostPeriod;
+    }
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::StridePolicy
+// 	Ready threads are kept in a heap keyed by pass.  The policy also
+//	keeps the bookkeeping for the achieved vs. target share report:
+//	"shareTime" grows by burst/activeTickets, so a runnable thread is
+//	entitled to tickets * (growth of shareTime) ticks of CPU.
+//----------------------------------------------------------------------
+
+StridePolicy::StridePolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, STRIDE_QUANTUM)
+{
+    strideHeap = new Heap;
+    globalPass = 0.0;
+    activeTickets = 0;
+    shareTime = 0.0;
+    shareCPUTicks = 0;
+    stateKind = STRIDE_STATE;
+}
+
+StridePolicy::~StridePolicy()
+{
+    delete strideHeap;
+}
+
+StrideState::StrideState(int threadTickets)
+    : SchedState(STRIDE_STATE)
+{
+    tickets = threadTickets;
+    pass = 0.0;
+    active = false;
+    joinTime = entitled = 0.0;
+    joinCPU = window = 0;
+}
+
+SchedState *
+StrideState::Fork()
+{
+    return new StrideState(tickets);
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Admit
+// 	A new thread holds the tickets of its batch priority (see
+//	policy.h); the main thread those of priority 0.
+//----------------------------------------------------------------------
+
+SchedState *
+StridePolicy::Admit(NachOSThread *thread)
+{
+    return new StrideState(STRIDE_MAX_TICKETS - thread->batchPriority);
+}
+
+void
+StridePolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    if (oldStatus != RUNNING)
+        Join(thread);
+    strideHeap->Insert((void *)thread, State(thread)->pass);
+}
+
+NachOSThread *
+StridePolicy::PickNext()
+{
+    return (NachOSThread *)strideHeap->RemoveMin(&globalPass);
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::BurstEnded
+// 	Charge the burst to the thread's pass, and to the share report.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    StrideState *state = State(thread);
+
+    if (burst > 0) {
+        if (activeTickets > 0)
+            shareTime += (double)burst / activeTickets;
+        shareCPUTicks += burst;
+        state->pass += (double)burst * STRIDE1 / state->tickets;
+    }
+    if (thread->getStatus() == BLOCKED && state->active)
+        Leave(thread);
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::ThreadExited
+// 	Hand the thread's share figures to the statistics.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::ThreadExited(NachOSThread *thread)
+{
+    StrideState *state = State(thread);
+
+    if (thread->GetPID() > 0)
+        stats->RecordShare(thread->GetPID(), state->tickets,
+                thread->cpu_burst_sum, state->entitled, state->window);
+}
+
+void
+StridePolicy::Migrated(NachOSThread *thread, SchedulingPolicy *from)
+{
+    if (State(thread)->active) {
+        ((StridePolicy *)from)->Leave(thread);
+        Join(thread);
+    }
+}
+
+void
+StridePolicy::Print()
+{
+    strideHeap->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// StridePolicy::Join, Leave
+// 	A thread enters or leaves the set of runnable threads that share
+//	the CPU.  A joining thread may not bank credit from the time it was
+//	blocked, so its pass is moved up to the global pass.
+//----------------------------------------------------------------------
+
+void
+StridePolicy::Join(NachOSThread *thread)
+{
+    StrideState *state = State(thread);
+
+    if (state->pass < globalPass)
+        state->pass = globalPass;
+    activeTickets += state->tickets;
+    state->joinTime = shareTime;
+    state->joinCPU = shareCPUTicks;
+    state->active = true;
+}
+
+void
+StridePolicy::Leave(NachOSThread *thread)
+{
+    StrideState *state = State(thread);
+
+    activeTickets -= state->tickets;
+    state->entitled += state->tickets * (shareTime - state->joinTime);
+    state->window += shareCPUTicks - state->joinCPU;
+    state->active = false;
+}
+
+//----------------------------------------------------------------------
+// CFSWeight
+// 	Map a batch priority (0..100, lower is better) onto the 40 nice
+//	levels of the Linux weight table, where each level gets about
+//	1.25 times the CPU of the next one.  Priorities 52 and 53 are nice 0.
+//----------------------------------------------------------------------
+
+static int cfsWeightTable[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+int
+CFSWeight (int priority)
+{
+    if (priority < 0)
+        priority = 0;
+    if (priority > 100)
+        priority = 100;
+    return cfsWeightTable[priority * 39 / 100];
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::CFSPolicy
+// 	Ready threads are kept in a red-black tree keyed by virtual
+//	runtime.  The timer is programmed with the minimum granularity;
+//	Tick checks the running thread's time slice.
+//----------------------------------------------------------------------
+
+CFSPolicy::CFSPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, CFS_MIN_GRANULARITY)
+{
+    cfsTree = new RBTree;
+    minVruntime = 0.0;
+    load = 0;
+    stateKind = CFS_STATE;
+}
+
+CFSPolicy::~CFSPolicy()
+{
+    delete cfsTree;
+}
+
+CFSState::CFSState(int threadWeight)
+    : SchedState(CFS_STATE)
+{
+    weight = threadWeight;
+    vruntime = 0.0;
+    active = false;
+}
+
+SchedState *
+CFSState::Fork()
+{
+    CFSState *child = new CFSState(weight);
+
+    child->vruntime = vruntime;
+    return child;
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::Admit
+// 	A new thread gets the weight of its batch priority; the main
+//	thread that of priority 0.
+//----------------------------------------------------------------------
+
+SchedState *
+CFSPolicy::Admit(NachOSThread *thread)
+{
+    return new CFSState(CFSWeight(thread->batchPriority));
+}
+
+void
+CFSPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    CFSState *state = State(thread);
+
+    if (oldStatus != RUNNING) {
+        // Don't let a thread that slept bank its unused time
+        if (state->vruntime < minVruntime)
+            state->vruntime = minVruntime;
+        load += state->weight;
+        state->active = true;
+    }
+    cfsTree->Insert((void *)thread, state->vruntime);
+}
+
+NachOSThread *
+CFSPolicy::PickNext()
+{
+    double vruntime;
+    NachOSThread *thread = (NachOSThread *)cfsTree->RemoveMin(&vruntime);
+
+    if (thread != NULL && vruntime > minVruntime)
+        minVruntime = vruntime;
+    return thread;
+}
+
+void
+CFSPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    CFSState *state = State(thread);
+
+    if (burst > 0)
+        state->vruntime += (double)burst * CFS_NICE0_WEIGHT / state->weight;
+    if (thread->getStatus() == BLOCKED && state->active) {
+        load -= state->weight;
+        state->active = false;
+    }
+}
+
+bool
+CFSPolicy::Tick(NachOSThread *thread)
+{
+    int burst = stats->totalTicks - thread->curr_cpu_burst_start;
+
+    return (burst >= TimeSlice(thread));
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::Migrated
+// 	Move the thread's weight over, and keep its virtual runtime at the
+//	same distance from the queue's minimum.
+//----------------------------------------------------------------------
+
+void
+CFSPolicy::Migrated(NachOSThread *thread, SchedulingPolicy *from)
+{
+    CFSPolicy *other = (CFSPolicy *)from;
+    CFSState *state = State(thread);
+
+    if (state->active) {
+        other->load -= state->weight;
+        state->vruntime += minVruntime - other->minVruntime;
+        load += state->weight;
+    }
+}
+
+void
+CFSPolicy::Print()
+{
+    cfsTree->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// CFSPolicy::TimeSlice
+// 	Return how long "thread", which is running, may keep the CPU:
+//	its weighted share of the scheduling period.
+//----------------------------------------------------------------------
+
+int
+CFSPolicy::TimeSlice(NachOSThread *thread)
+{
+    CFSState *state = State(thread);
+    int nrRunning = cfsTree->NumInTree() + 1;
+    int period = CFS_TARGET_LATENCY;
+    int total = load;
+    int slice;
+
+    if (nrRunning * CFS_MIN_GRANULARITY > period)
+        period = nrRunning * CFS_MIN_GRANULARITY;
+    if (!state->active)
+        total += state->weight;		// e.g. the main thread
+    slice = (int)((double)period * state->weight / total);
+    if (slice < CFS_MIN_GRANULARITY)
+        slice = CFS_MIN_GRANULARITY;
+    return slice;
+}
+
+//----------------------------------------------------------------------
+// EDFUtilization
+// 	Return the share of the CPU that a job with the given relative
+//	deadline, period (0 for a one-shot job) and worst-case execution
+//	ticks needs to be sure of meeting every deadline.
+//----------------------------------------------------------------------
+
+double
+EDFUtilization (int deadline, int period, int wcet)
+{
+    int window = deadline;
+
+    if (period > 0 && period < window)
+        window = period;
+    if (window <= 0)
+        return 0.0;
+    return (double)wcet / window;
+}
+
+//----------------------------------------------------------------------
+// EDFPolicy::EDFPolicy
+// 	Ready threads are kept in a heap keyed by absolute deadline.
+//----------------------------------------------------------------------
+
+EDFPolicy::EDFPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, DEFAULT_TIMER_PERIOD)
+{
+    deadlineHeap = new Heap;
+    utilization = 0.0;
+    preemptPending = false;
+    stateKind = EDF_STATE;
+}
+
+EDFPolicy::~EDFPolicy()
+{
+    delete deadlineHeap;
+}
+
+EDFState::EDFState()
+    : SchedState(EDF_STATE)
+{
+    absDeadline = -1;
+}
+
+SchedState *
+EDFState::Fork()
+{
+    EDFState *child = new EDFState;
+
+    child->absDeadline = absDeadline;
+    return child;
+}
+
+SchedState *
+EDFPolicy::Admit(NachOSThread *thread)
+{
+    EDFState *state = new EDFState;
+
+    if (thread->deadlineJob != NULL)
+        state->absDeadline = thread->deadlineJob->absDeadline;
+    return state;
+}
+
+//----------------------------------------------------------------------
+// EDFPolicy::DeclareJob
+// 	A new batch job with a deadline is ordered by the deadline of its
+//	first instance.  Its CPU share was reserved before it was created.
+//----------------------------------------------------------------------
+
+void
+EDFPolicy::DeclareJob(NachOSThread *thread, int group)
+{
+    if (thread->deadlineJob != NULL)
+        State(thread)->absDeadline = thread->deadlineJob->absDeadline;
+}
+
+void
+EDFPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    double deadline = DeadlineKey(thread);
+
+    deadlineHeap->Insert((void *)thread, deadline);
+    if (oldStatus != RUNNING && currentThread != NULL && currentThread != thread
+            && currentThread->getStatus() == RUNNING
+            && deadline < DeadlineKey(currentThread))
+        preemptPending = true;
+}
+
+NachOSThread *
+EDFPolicy::PickNext()
+{
+    preemptPending = false;     // whoever runs next was chosen afresh
+    return (NachOSThread *)deadlineHeap->RemoveMin(NULL);
+}
+
+//----------------------------------------------------------------------
+// EDFPolicy::BurstEnded
+// 	When a periodic job blocks, the scheduler has released its next
+//	instance; it is ordered by that instance's deadline from now on.
+//----------------------------------------------------------------------
+
+void
+EDFPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    if (thread->deadlineJob != NULL)
+        State(thread)->absDeadline = thread->deadlineJob->absDeadline;
+}
+
+//----------------------------------------------------------------------
+// EDFPolicy::ThreadExited
+// 	A deadline job gives back the CPU share it reserved.
+//----------------------------------------------------------------------
+
+void
+EDFPolicy::ThreadExited(NachOSThread *thread)
+{
+    DeadlineJob *job = thread->deadlineJob;
+
+    if (job != NULL)
+        utilization -= EDFUtilization(job->deadline, job->period, job->wcet);
+}
+
+bool
+EDFPolicy::PreemptPending()
+{
+    if (!SchedulingPolicy::PreemptPending())
+        return false;
+    stats->edf_preemptions++;
+    return true;
+}
+
+//----------------------------------------------------------------------
+// EDFPolicy::Reserve
+// 	Reserve "jobUtilization" of the CPU for a new deadline job and
+//	return TRUE, unless that would take the admitted jobs over the whole
+//	CPU; then return FALSE, and the job must not be run.
+//----------------------------------------------------------------------
+
+bool
+EDFPolicy::Reserve(double jobUtilization, int group)
+{
+    if (utilization + jobUtilization > 1.0 + 1e-9)
+        return false;
+    utilization += jobUtilization;
+    return true;
+}
+
+void
+EDFPolicy::Migrated(NachOSThread *thread, SchedulingPolicy *from)
+{
+    DeadlineJob *job = thread->deadlineJob;
+    double reserved;
+
+    if (job != NULL) {
+        reserved = EDFUtilization(job->deadline, job->period, job->wcet);
+        ((EDFPolicy *)from)->utilization -= reserved;
+        utilization += reserved;
+    }
+}
+
+void
+EDFPolicy::Print()
+{
+    deadlineHeap->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// EDFPolicy::DeadlineKey
+// 	Return the ready queue key of "thread": its absolute deadline, or
+//	EDF_NO_DEADLINE if it has none.
+//----------------------------------------------------------------------
+
+double
+EDFPolicy::DeadlineKey(NachOSThread *thread)
+{
+    int absDeadline = State(thread)->absDeadline;
+
+    if (absDeadline < 0)
+        return EDF_NO_DEADLINE;
+    return absDeadline;
+}
+
+//----------------------------------------------------------------------
+// GangPolicy
+// 	Ready threads are kept in a GangRunQueue, which does all the work.
+//----------------------------------------------------------------------
+
+GangPolicy::GangPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, GANG_QUANTUM)
+{
+    gangQueue = new GangRunQueue;
+    stateKind = GANG_STATE;
+}
+
+GangPolicy::~GangPolicy()
+{
+    delete gangQueue;
+}
+
+GangState::GangState(int id)
+    : SchedState(GANG_STATE)
+{
+    gangId = id;
+}
+
+SchedState *
+GangState::Fork()
+{
+    return new GangState(gangId);
+}
+
+//----------------------------------------------------------------------
+// GangPolicy::Admit
+// 	A thread that is not forked by one of a gang -- a batch job, or
+//	the main thread -- roots a gang of its own.
+//----------------------------------------------------------------------
+
+SchedState *
+GangPolicy::Admit(NachOSThread *thread)
+{
+    return new GangState(thread->GetPID());
+}
+
+void
+GangPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    gangQueue->Insert(thread, ((GangState *)StateOf(thread))->gangId);
+}
+
+NachOSThread *
+GangPolicy::PickNext()
+{
+    return gangQueue->RemoveNext();
+}
+
+void
+GangPolicy::Print()
+{
+    gangQueue->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+// Quanta of the default dispatch table, per ten levels
+static int tsDefaultQuanta[] = { 20, 40, 80, 120, 160, 200 };
+
+//----------------------------------------------------------------------
+// TSPolicy::TSPolicy
+// 	Ready threads are kept in a PriorityRunQueue by level.  The table
+//	comes from the scheduler's dispatch table file, if it is there and
+//	well formed.  The timer period, which only matters until the timer
+//	is next reprogrammed, is the smallest quantum.
+//----------------------------------------------------------------------
+
+TSPolicy::TSPolicy(NachOSscheduler *sched)
+    : SchedulingPolicy(sched, DEFAULT_TIMER_PERIOD)
+{
+    levelQueue = new PriorityRunQueue;
+    if (!LoadTable(owner->dispatchTableFile))
+        DefaultTable();
+    timerPeriod = table[0].quantum;
+    for (int i = 1; i < numLevels; i++) {
+        if (table[i].quantum < timerPeriod)
+            timerPeriod = table[i].quantum;
+    }
+    stateKind = TS_STATE;
+}
+
+TSPolicy::~TSPolicy()
+{
+    delete levelQueue;
+}
+
+TSState::TSState()
+    : SchedState(TS_STATE)
+{
+    level = -1;
+    timeLeft = 0;
+}
+
+SchedState *
+TSState::Fork()
+{
+    TSState *child = new TSState;
+
+    child->level = level;
+    return child;
+}
+
+SchedState *
+TSPolicy::Admit(NachOSThread *thread)
+{
+    return new TSState;
+}
+
+void
+TSPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    int level = LevelOf(thread);
+
+    levelQueue->Insert(thread, &State(thread)->link, level);
+    if (oldStatus == BLOCKED && currentThread != NULL
+            && currentThread != thread
+            && currentThread->getStatus() == RUNNING
+            && level < LevelOf(currentThread))
+        preemptPending = true;
+}
+
+NachOSThread *
+TSPolicy::PickNext()
+{
+    preemptPending = false;
+    return levelQueue->RemoveMin();
+}
+
+//----------------------------------------------------------------------
+// TSPolicy::BurstEnded
+// 	Move the thread to the level the table gives it for going to sleep
+//	or for using up its quantum.  Otherwise it was preempted by a
+//	better thread, or yielded, and keeps the rest of its quantum.
+//----------------------------------------------------------------------
+
+void
+TSPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    TSState *state = State(thread);
+    int level = LevelOf(thread);
+
+    if (thread->getStatus() == BLOCKED) {
+        state->level = table[level].sleepLevel;
+        state->timeLeft = 0;
+        return;
+    }
+    state->timeLeft -= burst;
+    if (thread->yieldAt || state->timeLeft <= 0) {
+        state->level = table[level].expiredLevel;
+        state->timeLeft = 0;
+    }
+}
+
+bool
+TSPolicy::Tick(NachOSThread *thread)
+{
+    int burst = stats->totalTicks - thread->curr_cpu_burst_start;
+
+    return (burst >= State(thread)->timeLeft) || PreemptPending();
+}
+
+//----------------------------------------------------------------------
+// TSPolicy::Dispatched
+// 	Give "thread" a new quantum of its level if it used up the last
+//	one, and return what it has left.
+//----------------------------------------------------------------------
+
+int
+TSPolicy::Dispatched(NachOSThread *thread)
+{
+    TSState *state = State(thread);
+
+    if (state->timeLeft <= 0)
+        state->timeLeft = table[LevelOf(thread)].quantum;
+    return state->timeLeft;
+}
+
+void
+TSPolicy::Print()
+{
+    levelQueue->Mapcar((VoidFunctionPtr) ThreadPrint);
+}
+
+//----------------------------------------------------------------------
+// TSPolicy::LoadTable
+// 	Read the dispatch table from the host file "fileName".  Return
+//	FALSE, leaving the table to the caller, if there is no such file;
+//	complain too if it is not a valid table.
+//----------------------------------------------------------------------
+
+bool
+TSPolicy::LoadTable(char *fileName)
+{
+    FILE *fp = fopen(fileName, "r");
+    char line[128];
+    DispatchEntry entry;
+    int fields, i;
+    bool valid = true;
+
+    if (fp == NULL)
+        return false;
+    numLevels = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#')
+            continue;
+        fields = sscanf(line, "%d %d %d", &entry.quantum,
+                &entry.expiredLevel, &entry.sleepLevel);
+        if (fields == EOF)
+            continue;           // blank line
+        if (fields != 3 || entry.quantum < 1 || numLevels == TS_MAX_LEVELS) {
+            valid = false;
+            break;
+        }
+        table[numLevels++] = entry;
+    }
+    fclose(fp);
+    for (i = 0; valid && i < numLevels; i++) {
+        if (table[i].expiredLevel < 0 || table[i].expiredLevel >= numLevels
+                || table[i].sleepLevel < 0 || table[i].sleepLevel >= numLevels)
+            valid = false;
+    }
+    if (!valid || numLevels == 0) {
+        printf("Bad dispatch table %s, using the default\n", fileName);
+        return false;
+    }
+    DEBUG('t', "Loaded %d-level dispatch table from %s\n", numLevels, fileName);
+    return true;
+}
+
+//----------------------------------------------------------------------
+// TSPolicy::DefaultTable
+// 	Set up the default dispatch table (see policy.h).
+//----------------------------------------------------------------------
+
+void
+TSPolicy::DefaultTable()
+{
+    numLevels = TS_MAX_LEVELS;
+    for (int i = 0; i < numLevels; i++) {
+        table[i].quantum = tsDefaultQuanta[i / 10];
+        table[i].expiredLevel = (i + 10 < numLevels) ? i + 10 : numLevels - 1;
+        table[i].sleepLevel = i / 6;
+    }
+}
+
+//----------------------------------------------------------------------
+// TSPolicy::LevelOf
+// 	Return the level of "thread", starting it on the one its batch
+//	priority maps to if it has none yet.
+//----------------------------------------------------------------------
+
+int
+TSPolicy::LevelOf(NachOSThread *thread)
+{
+    TSState *state = State(thread);
+    int level = state->level;
+
+    if (level < 0 || level >= numLevels) {
+        level = thread->batchPriority * (numLevels - 1) / 100;
+        if (level < 0)
+            level = 0;
+        if (level >= numLevels)
+            level = numLevels - 1;
+        state->level = level;
+    }
+    return level;
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::GroupFairPolicy
+// 	Initialize fair sharing between groups, with the threads of each
+//	group scheduled by the policy of schedulerCode "groupCode".  The timer
+//	is programmed for that policy.
+//----------------------------------------------------------------------
+
+GroupFairPolicy::GroupFairPolicy(NachOSscheduler *sched, int groupCode)
+    : SchedulingPolicy(sched, DEFAULT_TIMER_PERIOD)
+{
+    code = groupCode;
+    for (int i = 0; i < MAX_GROUPS; i++)
+	groups[i].policy = NULL;
+    numGroups = 0;
+    globalPass = 0.0;
+    activeShares = 0;
+    groupTime = 0.0;
+    cpuTicks = 0;
+    stateKind = GROUP_STATE;
+    timerPeriod = Group(0)->policy->TimerPeriod();
+}
+
+GroupFairPolicy::~GroupFairPolicy()
+{
+    for (int i = 0; i < numGroups; i++)
+	delete groups[i].policy;
+}
+
+GroupState::GroupState(int groupId)
+    : SchedState(GROUP_STATE)
+{
+    group = groupId;
+    active = false;
+    inner = NULL;
+}
+
+GroupState::~GroupState()
+{
+    delete inner;
+}
+
+SchedState *
+GroupState::Fork()
+{
+    GroupState *child = new GroupState(group);
+
+    if (inner != NULL)
+	child->inner = inner->Fork();
+    return child;
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::Admit
+// 	A thread is in the default group until the batch loader says
+//	otherwise (DeclareJob).
+//----------------------------------------------------------------------
+
+SchedState *
+GroupFairPolicy::Admit(NachOSThread *thread)
+{
+    return new GroupState(0);
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::Group
+// 	Return group "id", giving it a policy of its own the first time.
+//	Its share is the one the batch file registered for it.
+//----------------------------------------------------------------------
+
+ShareGroup *
+GroupFairPolicy::Group(int id)
+{
+    ShareGroup *group = &groups[id];
+
+    ASSERT(id >= 0 && id < MAX_GROUPS);
+    if (group->policy == NULL) {
+	group->policy = NewSchedulingPolicy(owner, code);
+	group->policy->NestIn(this);
+	if (id != 0)			// group 0 sets our period
+	    group->policy->SetTimerPeriod(timerPeriod);
+	group->share = (id < stats->num_groups) ? stats->group_records[id]->share : 1;
+	group->pass = 0.0;
+	group->numReady = group->numRunnable = 0;
+	group->joinTime = 0.0;
+	group->joinCPU = group->cpuUsed = 0;
+	if (id >= numGroups)
+	    numGroups = id + 1;
+    }
+    return group;
+}
+
+void
+GroupFairPolicy::ThreadReady(NachOSThread *thread, ThreadStatus oldStatus)
+{
+    GroupState *state = State(thread);
+    ShareGroup *group = Group(state->group);
+
+    if (!state->active) {
+	state->active = true;
+	if (group->numRunnable++ == 0)
+	    Join(state->group);
+    }
+    group->numReady++;
+    group->policy->ThreadReady(thread, oldStatus);
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::PickNext
+// 	Take the next thread of the group with ready threads and the
+//	smallest pass.  There are few groups, so they are simply scanned.
+//----------------------------------------------------------------------
+
+NachOSThread *
+GroupFairPolicy::PickNext()
+{
+    ShareGroup *best = NULL;
+
+    for (int i = 0; i < numGroups; i++) {
+	ShareGroup *group = &groups[i];
+
+	if (group->numReady > 0 && (best == NULL || group->pass < best->pass))
+	    best = group;
+    }
+    if (best == NULL)
+	return NULL;
+    globalPass = best->pass;
+    best->numReady--;
+    return best->policy->PickNext();
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::BurstEnded
+// 	Charge the burst to the thread's group, then let the group's
+//	policy charge it to the thread.
+//----------------------------------------------------------------------
+
+void
+GroupFairPolicy::BurstEnded(NachOSThread *thread, int burst)
+{
+    GroupState *state = State(thread);
+    ShareGroup *group = Group(state->group);
+
+    if (burst > 0) {
+	if (activeShares > 0)
+	    groupTime += (double)burst / activeShares;
+	cpuTicks += burst;
+	if (state->active)
+	    group->cpuUsed += burst;
+	group->pass += (double)burst * STRIDE1 / group->share;
+    }
+    group->policy->BurstEnded(thread, burst);
+    if (thread->getStatus() == BLOCKED && state->active) {
+	state->active = false;
+	if (--group->numRunnable == 0)
+	    Leave(state->group);
+    }
+}
+
+bool
+GroupFairPolicy::Tick(NachOSThread *thread)
+{
+    return Group(State(thread)->group)->policy->Tick(thread);
+}
+
+void
+GroupFairPolicy::ThreadExited(NachOSThread *thread)
+{
+    Group(State(thread)->group)->policy->ThreadExited(thread);
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::PreemptPending
+// 	Ask every group: a thread made ready in any of them may have to
+//	preempt the running thread.  All requests are consumed.
+//----------------------------------------------------------------------
+
+bool
+GroupFairPolicy::PreemptPending()
+{
+    bool pending = false;
+
+    for (int i = 0; i < numGroups; i++) {
+	if (groups[i].policy != NULL && groups[i].policy->PreemptPending())
+	    pending = true;
+    }
+    return pending;
+}
+
+bool
+GroupFairPolicy::Reserve(double utilization, int group)
+{
+    return Group(group)->policy->Reserve(utilization, group);
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::DeclareJob
+// 	Put a new batch job in its group; children it forks stay there.
+//	The group's policy then takes what it needs of the declaration.
+//----------------------------------------------------------------------
+
+void
+GroupFairPolicy::DeclareJob(NachOSThread *thread, int group)
+{
+    State(thread)->group = group;
+    Group(group)->policy->DeclareJob(thread, group);
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::Migrated
+// 	Move the thread from its group on the CPU it was stolen from to
+//	its group here, then let the group's policy move its own state.
+//----------------------------------------------------------------------
+
+void
+GroupFairPolicy::Migrated(NachOSThread *thread, SchedulingPolicy *from)
+{
+    GroupFairPolicy *other = (GroupFairPolicy *)from;
+    GroupState *state = State(thread);
+    int id = state->group;
+    ShareGroup *oldGroup = other->Group(id);
+    ShareGroup *group = Group(id);
+
+    if (state->active) {
+	if (--oldGroup->numRunnable == 0)
+	    other->Leave(id);
+	if (group->numRunnable++ == 0)
+	    Join(id);
+    }
+    group->policy->Migrated(thread, oldGroup->policy);
+}
+
+int
+GroupFairPolicy::Dispatched(NachOSThread *thread)
+{
+    return Group(State(thread)->group)->policy->Dispatched(thread);
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::SetTimerPeriod
+// 	The timer period of every group's policy follows ours, so that
+//	virtual round robin's quantum is the one the timer runs at.
+//----------------------------------------------------------------------
+
+void
+GroupFairPolicy::SetTimerPeriod(int period)
+{
+    timerPeriod = period;
+    for (int i = 0; i < numGroups; i++) {
+	if (groups[i].policy != NULL)
+	    groups[i].policy->SetTimerPeriod(period);
+    }
+}
+
+void
+GroupFairPolicy::Print()
+{
+    for (int i = 0; i < numGroups; i++) {
+	if (groups[i].policy != NULL) {
+	    printf("Group %d: ", i);
+	    groups[i].policy->Print();
+	    printf("\n");
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// GroupFairPolicy::Join, Leave
+// 	A group gets its first runnable thread, or loses its last one.
+//	As with stride scheduling of threads, a joining group may not bank
+//	credit from the time it had nothing to run.  On leaving, the CPU
+//	the group got and was entitled to meanwhile goes to the statistics.
+//----------------------------------------------------------------------
+
+void
+GroupFairPolicy::Join(int id)
+{
+    ShareGroup *group = &groups[id];
+
+    if (group->pass < globalPass)
+	group->pass = globalPass;
+    activeShares += group->share;
+    group->joinTime = groupTime;
+    group->joinCPU = cpuTicks;
+    group->cpuUsed = 0;
+}
+
+void
+GroupFairPolicy::Leave(int id)
+{
+    ShareGroup *group = &groups[id];
+
+    activeShares -= group->share;
+    if (id < stats->num_groups)
+	stats->RecordGroupShare(id, group->cpuUsed,
+		group->share * (groupTime - group->joinTime),
+		cpuTicks - group->joinCPU);
+}
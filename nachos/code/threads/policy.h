@@ -0,0 +1,783 @@
+// policy.h
+//	Data structures for the scheduling policies.
+//
+//	NachOSscheduler keeps what is common to every policy -- thread
+//	states, the count of ready threads, wait accounting -- and hands
+//	every scheduling decision to a SchedulingPolicy, chosen by
+//	schedulerCode.  Each policy owns its ready queue and keeps only its
+//	own bookkeeping, through five hooks:
+//
+//	ThreadReady	a thread joins the ready queue (on-ready)
+//	PickNext	take the thread to run next off it (pick-next)
+//	BurstEnded	the running thread stops running (on-burst-end)
+//	Tick		a timer interrupt: preempt the running thread? (on-tick)
+//	ThreadExited	a thread exits (on-exit)
+//
+//	What a policy knows about a thread is kept in a record of the
+//	policy's own (a SchedState), which the thread points to.  The policy
+//	makes it the first time it sees the thread (Admit), and the scheduler
+//	frees it once the thread has exited.  So a thread only carries the
+//	state of the policy that runs it.
+//
+//	The policy is selected once, so the dispatcher makes one virtual
+//	call per hook instead of testing schedulerCode on every call.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+#include "runqueue.h"
+#include "heap.h"
+#include "rbtree.h"
+#include "gangqueue.h"
+#include "stats.h"
+
+class NachOSscheduler;
+
+// Timer period of the policies that do not preempt, or only preempt
+// for a newly ready thread.
+#define DEFAULT_TIMER_PERIOD	100
+
+// Multilevel feedback queue (schedulerCode 11).  Level 0 is the best.
+// A thread that uses up its level's quantum moves one level down; a
+// thread that blocks (I/O, sleep, join) moves one level up.  Every
+// MLFQ_BOOST_PERIOD ticks all threads go back to level 0, so CPU-bound
+// threads at the bottom cannot starve.
+#define MLFQ_LEVELS		4
+#define MLFQ_BASE_QUANTUM	20	// level i gets MLFQ_BASE_QUANTUM << i
+#define MLFQ_BOOST_PERIOD	2000
+
+// UNIX priority scheduling (schedulerCode 7-10), see UnixPolicy.
+#define UNIX_BASE_PRIORITY	50	// of a thread of batch priority 0
+
+// Stride scheduling (schedulerCode 12).  A job with batch priority p
+// (0..100, lower is better) holds STRIDE_MAX_TICKETS - p tickets; forked
+// children inherit their parent's tickets.  Every tick of CPU advances
+// a thread's pass by STRIDE1 / tickets, and the ready thread with the
+// smallest pass runs next, so CPU time is split in proportion to tickets.
+#define STRIDE_MAX_TICKETS	101
+#define STRIDE1			(1 << 20)
+#define STRIDE_QUANTUM		50
+
+// Completely fair scheduling (schedulerCode 13).  Each thread's virtual
+// runtime grows by its CPU time scaled by CFS_NICE0_WEIGHT / weight, and
+// the ready thread with the least virtual runtime runs next.  The weight
+// comes from the batch priority (see CFSWeight); forked children inherit
+// their parent's weight.  Every runnable thread should get a turn within
+// CFS_TARGET_LATENCY ticks, so a thread's time slice is its weighted share
+// of that period, but never less than CFS_MIN_GRANULARITY; with many
+// threads the period is stretched instead.
+#define CFS_NICE0_WEIGHT	1024
+#define CFS_TARGET_LATENCY	200
+#define CFS_MIN_GRANULARITY	20
+
+extern int CFSWeight(int priority);	// weight for a batch priority
+
+// Adaptive smoothing for the SJF/SRTF burst estimator.  With
+// adaptiveAlpha set, each thread tunes its own alpha after every burst
+// by a normalized LMS step on the squared prediction error, kept
+// within [ALPHA_MIN, ALPHA_MAX].
+#define ALPHA_STEP		0.2
+#define ALPHA_MIN		0.05
+#define ALPHA_MAX		0.95
+
+// Shortest remaining time first (schedulerCode 14) is the preemptive
+// form of SJF.  Each thread keeps an exponential average of its past CPU
+// bursts; a ready thread is keyed by that estimate less what it has
+// already run of the current burst.  A thread that becomes ready with a
+// smaller key than the running thread's remaining time preempts it.
+// Bursts cut short by preemption are added up, so the average only sees
+// whole bursts.
+
+// Earliest deadline first (schedulerCode 15).  A batch job may declare a
+// relative deadline, a period and its worst-case execution ticks (wcet)
+// after its priority.  The ready thread with the earliest absolute
+// deadline runs next, and preempts the running thread if that is due
+// later; threads without a deadline only run when no deadline job is
+// ready.  A job is admitted only if the utilization of the admitted jobs,
+// each wcet / min(deadline, period), stays within 1, which is exactly
+// when EDF can meet all their deadlines.
+//
+// A periodic job finishes an instance each time it blocks; its next
+// instance is released one period after the last, with a new deadline.
+// Forked children run under their parent's deadline.  The scheduler
+// records the misses and lateness of deadline jobs under every policy
+// (DeadlineJob); EDF only orders and admits them.
+#define EDF_NO_DEADLINE		1e30	// heap key of threads without one
+
+extern double EDFUtilization(int deadline, int period, int wcet);
+					// CPU share a deadline job reserves
+
+// Gang scheduling (schedulerCode 16).  The threads of a process family
+// -- a batch job and all its forked descendants -- form a gang, and the
+// gang's ready threads run in consecutive GANG_QUANTUM slots before the
+// next gang gets a turn (see gangqueue.h).
+#define GANG_QUANTUM		30
+
+// Table-driven time sharing (schedulerCode 17), after the Solaris TS
+// class.  A dispatch table gives for each level (0 is the best) the
+// quantum of a thread at that level, the level it drops to when it uses
+// up its quantum, and the level it goes to when it wakes up from a sleep,
+// I/O or Join.  The table is read from a host file (-ts), one level per
+// line, lines starting with '#' being comments:
+//
+//	<quantum> <level after quantum expiry> <level after sleep return>
+//
+// Without a usable file, the default table is that of Solaris scaled to
+// ticks: 20-tick quanta on the best ten levels growing to 200 on the
+// worst ten, ten levels down on expiry, and a wake-up into the best ten.
+// A job with batch priority p (0..100) starts on level
+// p * (levels - 1) / 100, and forked children on their parent's level.
+//
+// A thread preempted before its quantum is up, or that yields, keeps the
+// rest of it for its next turn.  On a uniprocessor the timer is
+// reprogrammed on every dispatch with what is left of the incoming
+// thread's quantum.  Several CPUs share the timer, so there each CPU
+// keeps the end of its own thread's slice, and checks it on that tick.
+#define TS_MAX_LEVELS		60
+#define DISPATCH_TABLE_FILE	"dispatch_table"
+
+// Virtual round robin (schedulerCode 18).  Under round robin a thread
+// that blocks for I/O before using up its quantum loses the rest, and
+// then waits behind the CPU-bound threads.  Here it comes back on an
+// auxiliary FIFO, which goes before the main one, and runs from there
+// only for what was left of its quantum; once that is used up, or it is
+// preempted, it goes back to the main FIFO and a whole quantum.  The
+// quantum is the timer's period, VRR_QUANTUM unless the batch file names
+// one.  On a uniprocessor the timer is reprogrammed on every dispatch
+// for the slice; several CPUs share the timer, so there each CPU keeps
+// the end of its own thread's slice.
+#define VRR_QUANTUM		60
+
+// Round robin with a load-adaptive quantum (schedulerCode 19).  Every
+// runnable thread should get a turn within DRR_TARGET_LATENCY ticks, so
+// a thread is dispatched for that divided by the number of runnable
+// threads (the ready ones and itself), but never less than
+// DRR_MIN_GRANULARITY.  Light load gets long slices and few switches;
+// under heavy load the response time stays bounded.  On a uniprocessor
+// the timer is reprogrammed on every dispatch for the slice; with several
+// CPUs each CPU keeps the end of its own thread's slice.
+#define DRR_TARGET_LATENCY	200
+#define DRR_MIN_GRANULARITY	20
+
+// Hierarchical fair share (any schedulerCode, when the batch file tags
+// jobs with groups).  Batch jobs belong to groups -- teams, tenants --
+// each with a CPU share; forked children stay in their parent's group.
+// Groups take the CPU by stride scheduling on their shares: the group
+// with runnable threads and the smallest pass goes next, and every tick
+// its threads run advances its pass by STRIDE1 / share.  Within a group
+// the threads are scheduled by the batch file's policy, each group with
+// its own instance of it.  So a group's CPU does not grow with the
+// number of jobs it submits.
+
+// The kinds of per-thread scheduling state.  Policies of one kind (all
+// round robin quanta, SJF and SRTF, ...) understand each other's records.
+
+enum SchedStateKind { FCFS_STATE, VRR_STATE, BURST_STATE, UNIX_STATE,
+		      MLFQ_STATE, STRIDE_STATE, CFS_STATE, EDF_STATE,
+		      GANG_STATE, TS_STATE, GROUP_STATE };
+
+// The following class defines what every policy's record of a thread
+// has: its kind, and what a child forked by the thread inherits.
+
+class SchedState {
+  public:
+    SchedState(SchedStateKind stateKind) { kind = stateKind; }
+    virtual ~SchedState() {}
+
+    virtual SchedState *Fork() { return NULL; }
+					// The record a child forked by our
+					// thread starts with; NULL to have
+					// the policy admit it afresh
+
+    SchedStateKind kind;
+};
+
+// First come first served and round robin.
+
+class FCFSState : public SchedState {
+  public:
+    FCFSState(SchedStateKind stateKind);
+
+    int ioBurst;			// CPU ticks since the thread last
+					// blocked, across preemptions
+};
+
+// Virtual round robin.
+
+class VRRState : public FCFSState {
+  public:
+    VRRState();
+
+    int left;				// rest of the quantum it blocked in,
+					// 0 for a whole one
+};
+
+// SJF and SRTF.
+
+class BurstState : public SchedState {
+  public:
+    BurstState();
+    SchedState *Fork();			// the child inherits the estimate
+
+    double estimate;			// predicted next CPU burst
+    int burstDone;			// ticks run since the thread last
+					// blocked (SRTF)
+    double alpha;			// adaptive estimator alpha, -1 if unset
+    double alphaGrad;			// last prediction's slope in alpha
+    int predictionCount;		// bursts predicted so far
+    double absError;			// sum of absolute prediction errors
+    double relError;			// sum of relative prediction errors
+};
+
+// UNIX priority scheduling.
+
+class UnixState : public SchedState {
+  public:
+    UnixState(int base, int epoch);
+
+    int basePriority;			// UNIX_BASE_PRIORITY + batch priority
+    int priority;			// basePriority + cpuCount/2, lower
+					// is better
+    RunQueueLink link;			// our place on the priority queue
+    int cpuCount;			// recent CPU usage, as of cpuEpoch
+    int cpuEpoch;			// decay epoch cpuCount is valid for
+    NachOSThread *decayNext;		// links for the policy's decay list
+    NachOSThread *decayPrev;
+    bool onDecayList;
+    NachOSThread *ageNext;		// links for the policy's list of
+    NachOSThread *agePrev;		// ready threads by wait, with aging
+};
+
+// Multilevel feedback queue.
+
+class MLFQState : public SchedState {
+  public:
+    MLFQState();
+
+    int level;				// 0 is the best
+    int boostPeriod;			// boost period "level" is valid for
+};
+
+// Stride scheduling.
+
+class StrideState : public SchedState {
+  public:
+    StrideState(int threadTickets);
+    SchedState *Fork();			// the child inherits the tickets
+
+    int tickets;
+    double pass;
+    bool active;			// counted in the policy's activeTickets?
+    double joinTime;			// policy's shareTime when last made
+					// runnable
+    int joinCPU;			// policy's shareCPUTicks then
+    double entitled;			// CPU ticks the tickets entitled us to
+    int window;				// CPU ticks used by everyone while we
+					// were runnable
+};
+
+// Completely fair scheduling.
+
+class CFSState : public SchedState {
+  public:
+    CFSState(int threadWeight);
+    SchedState *Fork();			// the child inherits weight and
+					// virtual runtime
+
+    int weight;				// load weight
+    double vruntime;			// weighted virtual runtime
+    bool active;			// counted in the policy's load?
+};
+
+// Earliest deadline first.
+
+class EDFState : public SchedState {
+  public:
+    EDFState();
+    SchedState *Fork();			// the child runs under our deadline
+
+    int absDeadline;			// of our deadline job's current
+					// instance, -1 if none
+};
+
+// Gang scheduling.
+
+class GangState : public SchedState {
+  public:
+    GangState(int id);
+    SchedState *Fork();			// the child joins our gang
+
+    int gangId;				// pid of the root of our family
+};
+
+// Table-driven time sharing.
+
+class TSState : public SchedState {
+  public:
+    TSState();
+    SchedState *Fork();			// the child starts on our level
+
+    int level;				// dispatch table level, -1 if unset
+    int timeLeft;			// rest of its quantum, 0 if used up
+    RunQueueLink link;			// our place on the level queue
+};
+
+// Hierarchical fair share.  The record of the policy within the group
+// is kept inside the group's.
+
+class GroupState : public SchedState {
+  public:
+    GroupState(int groupId);
+    ~GroupState();
+    SchedState *Fork();			// the child stays in our group
+
+    int group;				// fair-share group of our batch job
+    bool active;			// counted in the group's runnable
+					// threads?
+    SchedState *inner;			// the group policy's record, NULL
+					// until it has seen the thread
+};
+
+// The following class defines the interface of a scheduling policy.
+// Hooks that a policy has no use for do nothing.  All are called with
+// interrupts disabled.
+
+class SchedulingPolicy {
+  public:
+    SchedulingPolicy(NachOSscheduler *sched, int period);
+    virtual ~SchedulingPolicy() {}
+
+    virtual void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus) = 0;
+					// Put "thread", which was in state
+					// "oldStatus", on the ready queue
+    virtual NachOSThread *PickNext() = 0;
+					// Remove the thread to run next,
+					// NULL if none is ready
+    virtual void BurstEnded(NachOSThread *thread, int burst) {}
+					// "thread" ran "burst" ticks; it is
+					// BLOCKED if it stops being runnable
+    virtual bool Tick(NachOSThread *thread) { return false; }
+					// Timer interrupt while "thread" runs:
+					// should it be preempted?
+    virtual void ThreadExited(NachOSThread *thread) {}
+					// "thread" exits, after BurstEnded
+
+    virtual bool PreemptPending();	// Has a newly ready thread asked to
+					// preempt the running one?  Consumes
+					// the request.
+    virtual bool Reserve(double utilization, int group) { return true; }
+					// Admission control of deadline jobs
+					// of fair-share group "group"
+    virtual void DeclareJob(NachOSThread *thread, int group) {}
+					// "thread" is a new batch job of
+					// fair-share group "group"; its
+					// deadline, if any, is declared
+    virtual void Migrated(NachOSThread *thread, SchedulingPolicy *from) {}
+					// "thread" was stolen from "from",
+					// a policy of the same kind
+    virtual int Dispatched(NachOSThread *thread) { return 0; }
+					// "thread" is about to run: ticks
+					// until the timer should interrupt,
+					// 0 to leave the timer alone
+
+    virtual void Print() = 0;		// Print the ready queue
+
+    int TimerPeriod() { return timerPeriod; }
+					// Ticks between timer interrupts
+    virtual void SetTimerPeriod(int period) { timerPeriod = period; }
+					// The batch file programs the timer
+					// with "period" instead
+    SchedState *ForkState(NachOSThread *parent);
+					// The record of a child "parent"
+					// is forking
+    void NestIn(SchedulingPolicy *groupPolicy) { outer = groupPolicy; }
+					// Schedule the threads of one group
+					// of "groupPolicy"
+
+  protected:
+    virtual SchedState *Admit(NachOSThread *thread) = 0;
+					// A new record for "thread", which
+					// no policy of our kind has seen
+    SchedState *StateOf(NachOSThread *thread);
+					// Our record of "thread", admitting
+					// it if there is none yet
+
+    NachOSscheduler *owner;		// the scheduler we decide for
+    int timerPeriod;
+    bool preemptPending;		// a ready thread beats the running
+					// one; cleared by PickNext
+    SchedStateKind stateKind;		// the kind of our records
+    SchedulingPolicy *outer;		// the fair-share policy whose groups
+					// we schedule within, or NULL
+};
+
+extern SchedulingPolicy *NewSchedulingPolicy(NachOSscheduler *owner, int code);
+					// The policy for schedulerCode "code"
+
+// First come first served (schedulerCode 1).
+
+class FCFSPolicy : public SchedulingPolicy {
+  public:
+    FCFSPolicy(NachOSscheduler *sched);
+    ~FCFSPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+    FCFSState *State(NachOSThread *thread) { return (FCFSState *)StateOf(thread); }
+
+    List *readyList;			// FIFO of ready threads
+};
+
+// Round robin with a fixed quantum (schedulerCode 3-6), preempting on
+// every timer interrupt: the timer is programmed with the quantum.
+
+class RoundRobinPolicy : public FCFSPolicy {
+  public:
+    RoundRobinPolicy(NachOSscheduler *sched, int quantum);
+
+    bool Tick(NachOSThread *thread) { return true; }
+};
+
+class VirtualRoundRobinPolicy : public RoundRobinPolicy {
+  public:
+    VirtualRoundRobinPolicy(NachOSscheduler *sched, int quantum);
+    ~VirtualRoundRobinPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    int Dispatched(NachOSThread *thread);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    VRRState *State(NachOSThread *thread) { return (VRRState *)StateOf(thread); }
+    int Slice(NachOSThread *thread);	// ticks "thread" may run next
+
+    List *auxList;			// FIFO of threads back from I/O with
+					// part of their quantum left
+};
+
+class DynamicRoundRobinPolicy : public RoundRobinPolicy {
+  public:
+    DynamicRoundRobinPolicy(NachOSscheduler *sched);
+
+    bool Tick(NachOSThread *thread);
+    int Dispatched(NachOSThread *thread) { return Slice(); }
+
+  private:
+    int Slice();			// the quantum under the current load
+};
+
+// Policies that predict each thread's next CPU burst by an exponential
+// average, and report how good the predictions were.
+
+class BurstPredictingPolicy : public SchedulingPolicy {
+  public:
+    BurstPredictingPolicy(NachOSscheduler *sched);
+    ~BurstPredictingPolicy();
+
+    void ThreadExited(NachOSThread *thread);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+    BurstState *State(NachOSThread *thread) { return (BurstState *)StateOf(thread); }
+    double PredictBurst(NachOSThread *thread, int burst, double predicted);
+					// Record an error, and predict again
+
+    Heap *burstHeap;			// ready threads by predicted burst
+};
+
+// Shortest job first (schedulerCode 2), non-preemptive.  With aging, a
+// ready thread's key is its predicted burst less agingRate per tick it
+// has waited.  All ready threads age alike, so adding agingRate times
+// the time the wait began gives the same order, and that key is fixed.
+
+class SJFPolicy : public BurstPredictingPolicy {
+  public:
+    SJFPolicy(NachOSscheduler *sched) : BurstPredictingPolicy(sched) {}
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+};
+
+class SRTFPolicy : public BurstPredictingPolicy {
+  public:
+    SRTFPolicy(NachOSscheduler *sched);
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread) { return PreemptPending(); }
+    bool PreemptPending();
+
+  private:
+    double RemainingBurst(NachOSThread *thread);
+};
+
+// UNIX priority scheduling (schedulerCode 7-10): priority is the base
+// priority, UNIX_BASE_PRIORITY plus the batch priority, plus half the
+// recent CPU usage, which is halved on every burst that ends.  With
+// aging, a ready thread's effective priority is its priority less
+// agingRate per tick it has waited.  The ready threads
+// are also kept in the order they began waiting, and the longest waiting
+// one runs next if its effective priority beats that of the first thread
+// on the best level; so no thread waits forever.  A thread that wakes up
+// with a better priority than the running thread preempts it.
+
+class UnixPolicy : public SchedulingPolicy {
+  public:
+    UnixPolicy(NachOSscheduler *sched, int quantum);
+    ~UnixPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread) { return true; }
+    void Migrated(NachOSThread *thread, SchedulingPolicy *from);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    UnixState *State(NachOSThread *thread) { return (UnixState *)StateOf(thread); }
+    void ChargeCPU(NachOSThread *thread, int burst);
+    void UpdatePriority(NachOSThread *thread);
+    void SetPriority(NachOSThread *thread, int newPriority);
+    void AddToDecayList(NachOSThread *thread);
+    void RemoveFromDecayList(NachOSThread *thread);
+    double EffectivePriority(NachOSThread *thread);
+    void RemoveFromAgeList(NachOSThread *thread);
+
+    PriorityRunQueue *priorityQueue;	// ready threads by priority
+    int decayEpoch;			// number of decay steps so far
+    NachOSThread *decayList;		// ready threads whose cpuCount is
+					// still non-zero (their priority
+					// changes every epoch)
+    NachOSThread *ageHead;		// ready threads, longest waiting
+    NachOSThread *ageTail;		// first; only kept with aging on
+};
+
+class MLFQPolicy : public SchedulingPolicy {
+  public:
+    MLFQPolicy(NachOSscheduler *sched);
+    ~MLFQPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    bool Tick(NachOSThread *thread);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    MLFQState *State(NachOSThread *thread) { return (MLFQState *)StateOf(thread); }
+    void Boost();
+
+    List *queue[MLFQ_LEVELS];		// ready threads of each level
+    int boostPeriod;			// boost period of the last
+					// anti-starvation reset
+};
+
+class StridePolicy : public SchedulingPolicy {
+  public:
+    StridePolicy(NachOSscheduler *sched);
+    ~StridePolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread) { return true; }
+    void ThreadExited(NachOSThread *thread);
+    void Migrated(NachOSThread *thread, SchedulingPolicy *from);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    StrideState *State(NachOSThread *thread) { return (StrideState *)StateOf(thread); }
+    void Join(NachOSThread *thread);
+    void Leave(NachOSThread *thread);
+
+    Heap *strideHeap;			// ready threads by pass value
+    double globalPass;			// pass of the last thread picked
+    int activeTickets;			// tickets held by runnable threads
+    double shareTime;			// CPU ticks handed out per ticket
+    int shareCPUTicks;			// CPU ticks used by all threads
+};
+
+class CFSPolicy : public SchedulingPolicy {
+  public:
+    CFSPolicy(NachOSscheduler *sched);
+    ~CFSPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread);
+    void Migrated(NachOSThread *thread, SchedulingPolicy *from);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    CFSState *State(NachOSThread *thread) { return (CFSState *)StateOf(thread); }
+    int TimeSlice(NachOSThread *thread);
+
+    RBTree *cfsTree;			// ready threads by virtual runtime
+    double minVruntime;			// never decreases; floor for threads
+					// that become runnable
+    int load;				// total weight of runnable threads
+};
+
+class EDFPolicy : public SchedulingPolicy {
+  public:
+    EDFPolicy(NachOSscheduler *sched);
+    ~EDFPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread) { return PreemptPending(); }
+    void ThreadExited(NachOSThread *thread);
+    bool PreemptPending();
+    bool Reserve(double jobUtilization, int group);
+    void DeclareJob(NachOSThread *thread, int group);
+    void Migrated(NachOSThread *thread, SchedulingPolicy *from);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    EDFState *State(NachOSThread *thread) { return (EDFState *)StateOf(thread); }
+    double DeadlineKey(NachOSThread *thread);
+
+    Heap *deadlineHeap;			// ready threads by absolute deadline
+    double utilization;			// reserved by admitted deadline jobs
+};
+
+class GangPolicy : public SchedulingPolicy {
+  public:
+    GangPolicy(NachOSscheduler *sched);
+    ~GangPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    bool Tick(NachOSThread *thread) { return true; }
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    GangRunQueue *gangQueue;		// ready threads by process family
+};
+
+// One level of the time-sharing dispatch table.
+
+class DispatchEntry {
+  public:
+    int quantum;			// ticks a thread on this level may run
+    int expiredLevel;			// its level once they are used up
+    int sleepLevel;			// its level when it wakes up
+};
+
+class TSPolicy : public SchedulingPolicy {
+  public:
+    TSPolicy(NachOSscheduler *sched);
+    ~TSPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread);
+    int Dispatched(NachOSThread *thread);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    TSState *State(NachOSThread *thread) { return (TSState *)StateOf(thread); }
+    bool LoadTable(char *fileName);	// FALSE if the file is not usable
+    void DefaultTable();
+    int LevelOf(NachOSThread *thread);	// the thread's level, set from its
+					// batch priority the first time
+
+    DispatchEntry table[TS_MAX_LEVELS];
+    int numLevels;
+    PriorityRunQueue *levelQueue;	// ready threads by level
+};
+
+// The state of one fair-share group on one CPU.
+
+class ShareGroup {
+  public:
+    SchedulingPolicy *policy;		// schedules the group's threads,
+					// NULL until one is ready
+    int share;
+    double pass;			// stride pass of the group
+    int numReady;			// threads on policy's ready queue
+    int numRunnable;			// ready or running threads
+    double joinTime;			// groupTime when last made runnable
+    int joinCPU;			// cpuTicks when last made runnable
+    int cpuUsed;			// CPU ticks run since then
+};
+
+class GroupFairPolicy : public SchedulingPolicy {
+  public:
+    GroupFairPolicy(NachOSscheduler *sched, int groupCode);
+    ~GroupFairPolicy();
+
+    void ThreadReady(NachOSThread *thread, ThreadStatus oldStatus);
+    NachOSThread *PickNext();
+    void BurstEnded(NachOSThread *thread, int burst);
+    bool Tick(NachOSThread *thread);
+    void ThreadExited(NachOSThread *thread);
+    bool PreemptPending();
+    bool Reserve(double utilization, int group);
+    void DeclareJob(NachOSThread *thread, int group);
+    void Migrated(NachOSThread *thread, SchedulingPolicy *from);
+    int Dispatched(NachOSThread *thread);
+    void SetTimerPeriod(int period);
+    void Print();
+
+  protected:
+    SchedState *Admit(NachOSThread *thread);
+
+  private:
+    GroupState *State(NachOSThread *thread) { return (GroupState *)StateOf(thread); }
+    ShareGroup *Group(int id);		// the group, its policy made
+    void Join(int id);			// group gets a runnable thread
+    void Leave(int id);			// group has none left
+
+    int code;				// schedulerCode within groups
+    ShareGroup groups[MAX_GROUPS];
+    int numGroups;			// groups used so far
+    double globalPass;			// pass of the last group picked
+    int activeShares;			// shares of groups with runnable threads
+    double groupTime;			// CPU ticks handed out per share
+    int cpuTicks;			// CPU ticks used by all groups
+};
+
+#endif // POLICY_H
@@ -0,0 +1,346 @@
+// processor.cc
+//	Routines to simulate several CPUs on the one host thread.
+//
+//	Switching the simulated CPU is a thread switch (_SWITCH) from the
+//	thread running on one CPU to the thread running on the next,
+//	together with swapping the register file, page table register and
+//	ready queue.  Unlike NachOSscheduler::Schedule, it is not a
+//	scheduling event: neither thread changes state, and no burst or
+//	wait time is accounted.
+//
+//	A thread is suspended in SwitchProcessor only while it is the
+//	running thread of some CPU, and it is resumed only by
+//	SwitchProcessor.  Threads on ready queues, including threads that
+//	are stolen by another CPU, are suspended in Schedule as usual.
+//
+//	Interrupts stay enabled across SwitchProcessor.  Simulated
+//	interrupts are only delivered from OneTick, OneRound and Idle, so
+//	nothing can happen in the middle of these routines.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "processor.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// Processor::Processor
+//	Initialize the state of CPU "cpuId", whose ready queue is
+//	"cpuQueue".  The CPU has no thread until StartProcessors.
+//----------------------------------------------------------------------
+
+Processor::Processor(int cpuId, NachOSscheduler *cpuQueue)
+{
+    id = cpuId;
+    readyQueue = cpuQueue;
+    thread = NULL;
+    idleThread = NULL;
+    status = SystemMode;
+    preemptPending = false;
+    sliceEnd = 0;
+#ifdef USER_PROGRAM
+    for (int i = 0; i < NumTotalRegs; i++)
+	registers[i] = 0;
+    pageTable = NULL;
+    pageTableSize = 0;
+#endif
+}
+
+//----------------------------------------------------------------------
+// Processor::SaveState
+//	The CPU is being switched out: copy its registers, page table
+//	register, mode and running thread out of the simulated machine.
+//----------------------------------------------------------------------
+
+void
+Processor::SaveState()
+{
+#ifdef USER_PROGRAM
+    for (int i = 0; i < NumTotalRegs; i++)
+	registers[i] = machine->registers[i];
+    pageTable = machine->NachOSpageTable;
+    pageTableSize = machine->NachOSpageTableSize;
+#endif
+    status = interrupt->getStatus();
+    thread = currentThread;
+}
+
+//----------------------------------------------------------------------
+// Processor::RestoreState
+//	Make this the CPU being simulated.  The caller must then switch
+//	to "currentThread".
+//----------------------------------------------------------------------
+
+void
+Processor::RestoreState()
+{
+#ifdef USER_PROGRAM
+    for (int i = 0; i < NumTotalRegs; i++)
+	machine->registers[i] = registers[i];
+    machine->NachOSpageTable = pageTable;
+    machine->NachOSpageTableSize = pageTableSize;
+#endif
+    interrupt->setStatus(status);
+    currentThread = thread;
+    scheduler = readyQueue;
+    currentCPU = id;
+}
+
+//----------------------------------------------------------------------
+// Processor::StartSlice
+//	The CPU's new thread may run for "quantum" ticks before the policy
+//	is asked whether to preempt it, whatever the shared timer does
+//	meanwhile.  With 0 it is asked on every timer interrupt.
+//----------------------------------------------------------------------
+
+void
+Processor::StartSlice(int quantum)
+{
+    sliceEnd = (quantum > 0) ? stats->totalTicks + quantum : 0;
+}
+
+//----------------------------------------------------------------------
+// Processor::ShouldPreempt
+//	Return TRUE if "running", the CPU's thread, is to be preempted now:
+//	never before the end of its slice, and from then on whenever its
+//	scheduler says so.
+//----------------------------------------------------------------------
+
+bool
+Processor::ShouldPreempt(NachOSThread *running)
+{
+    if (sliceEnd > stats->totalTicks)
+	return false;
+    sliceEnd = 0;
+    return readyQueue->ShouldPreempt(running);
+}
+
+//----------------------------------------------------------------------
+// SwitchProcessor
+//	Stop simulating the current CPU and go on to the next one.
+//	Returns when the current CPU's turn comes round again.  When the
+//	last CPU hands over to the first, every CPU has had a turn, and
+//	simulated time moves on by one tick.
+//----------------------------------------------------------------------
+
+static void
+SwitchProcessor()
+{
+    NachOSThread *oldThread = currentThread;
+
+    if (currentCPU == numCPUs - 1)
+	interrupt->OneRound();
+    processors[currentCPU]->SaveState();
+    processors[(currentCPU + 1) % numCPUs]->RestoreState();
+
+    if (currentThread != oldThread)
+	_SWITCH(oldThread, currentThread);
+}
+
+//----------------------------------------------------------------------
+// ProcessorTick
+//	Called by Machine::Run in place of Interrupt::OneTick, when the
+//	current CPU has executed a user instruction.  Let the other CPUs
+//	execute theirs, then, if the timer asked this CPU to reschedule
+//	meanwhile, or the slice of its thread is up, yield as OneTick
+//	would have.
+//----------------------------------------------------------------------
+
+void
+ProcessorTick()
+{
+    Processor *cpu;
+
+    stats->userTicks += UserTick;
+    stats->cpu_busy_ticks[currentCPU] += UserTick;
+
+    SwitchProcessor();
+
+    cpu = processors[currentCPU];
+    if (cpu->sliceEnd > 0 && cpu->sliceEnd <= stats->totalTicks
+	    && cpu->ShouldPreempt(currentThread)) {
+	currentThread->yieldAt = true;
+	cpu->preemptPending = true;
+    }
+    if (cpu->preemptPending) {
+	cpu->preemptPending = false;
+	interrupt->setStatus(SystemMode);	// yield is a kernel routine
+	currentThread->YieldCPU();
+	interrupt->setStatus(UserMode);
+    }
+}
+
+//----------------------------------------------------------------------
+// PreemptProcessors
+//	Called from the scheduler's timer interrupt handler.  Each CPU
+//	asks its own scheduler whether its running thread has used up its
+//	quantum; if so it yields at the end of its next instruction.  Idle
+//	CPUs, and threads whose own slice is not up yet, are left alone.
+//----------------------------------------------------------------------
+
+void
+PreemptProcessors()
+{
+    for (int i = 0; i < numCPUs; i++) {
+	Processor *cpu = processors[i];
+	NachOSThread *thread = (i == currentCPU) ? currentThread : cpu->thread;
+
+	if (thread != cpu->idleThread && cpu->ShouldPreempt(thread)) {
+	    thread->yieldAt = true;
+	    cpu->preemptPending = true;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// StealThread
+//	Called when the current CPU has nothing on its own ready queue.
+//	Take the next thread from the CPU with the most ready threads, and
+//	move its scheduling state over to this CPU's scheduler.
+//
+// Returns:
+//	The stolen thread, which the caller must run; NULL if every
+//	other ready queue is empty too.
+//----------------------------------------------------------------------
+
+NachOSThread *
+StealThread()
+{
+    Processor *victim = NULL;
+    NachOSThread *thread;
+    int most = 0;
+
+    for (int i = 0; i < numCPUs; i++) {
+	if (i != currentCPU && processors[i]->readyQueue->NumReady() > most) {
+	    victim = processors[i];
+	    most = victim->readyQueue->NumReady();
+	}
+    }
+    if (victim == NULL)
+	return NULL;
+
+    thread = victim->readyQueue->FindNextThreadToRun();
+    scheduler->Migrate(thread, victim->readyQueue);
+    stats->cpu_migrations[currentCPU]++;
+    DEBUG('t', "CPU %d steals thread \"%s\" with pid %d from CPU %d\n",
+	  currentCPU, thread->getName(), thread->GetPID(), victim->id);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// IdleThread
+//	Return the thread the current CPU should switch to when its
+//	running thread blocks and nothing is ready: its idle thread, or
+//	NULL on a uniprocessor, where the caller waits in Interrupt::Idle.
+//----------------------------------------------------------------------
+
+NachOSThread *
+IdleThread()
+{
+    if (numCPUs == 1)
+	return NULL;
+    return processors[currentCPU]->idleThread;
+}
+
+//----------------------------------------------------------------------
+// AllProcessorsIdle
+//	Return TRUE if every CPU is running its idle thread and no thread
+//	is ready anywhere.
+//----------------------------------------------------------------------
+
+static bool
+AllProcessorsIdle()
+{
+    for (int i = 0; i < numCPUs; i++) {
+	Processor *cpu = processors[i];
+	NachOSThread *thread = (i == currentCPU) ? currentThread : cpu->thread;
+
+	if (thread != cpu->idleThread || cpu->readyQueue->NumReady() > 0)
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// IdleLoop
+//	Body of each CPU's idle thread.  Run whatever becomes ready on
+//	this CPU, or can be stolen from another; otherwise pass the turn
+//	on to the next CPU.  Only when all CPUs are idle does simulated
+//	time jump to the next pending interrupt, as Interrupt::Idle does
+//	on a uniprocessor.
+//
+//	"which" is the number of the CPU.
+//----------------------------------------------------------------------
+
+static void
+IdleLoop(int which)
+{
+    NachOSThread *nextThread;
+
+    scheduler->Tail();		// we may have been switched to by Exit
+    DEBUG('t', "Idle thread of CPU %d starting\n", which);
+
+    for (;;) {
+	nextThread = scheduler->FindNextThreadToRun();
+	if (nextThread == NULL)
+	    nextThread = StealThread();
+
+	if (nextThread != NULL) {
+	    (void) interrupt->SetLevel(IntOff);
+	    scheduler->Schedule(nextThread);	// back when the CPU runs dry
+	    (void) interrupt->SetLevel(IntOn);
+	} else if (AllProcessorsIdle()) {
+	    (void) interrupt->SetLevel(IntOff);
+	    interrupt->Idle();			// halts if nothing is pending
+	    (void) interrupt->SetLevel(IntOn);
+	} else
+	    SwitchProcessor();
+    }
+}
+
+//----------------------------------------------------------------------
+// StartProcessors
+//	Called at startup, with "-ncpu n".  CPU 0, whose ready queue is
+//	the original scheduler and whose thread is main, already exists;
+//	create CPUs 1..n-1 with schedulers configured like CPU 0's, and an
+//	idle thread for every CPU.
+//----------------------------------------------------------------------
+
+void
+StartProcessors(int n)
+{
+    NachOSThread *mainThread = currentThread;
+    NachOSThread *idle;
+    NachOSscheduler *readyQueue;
+    int i;
+
+    ASSERT(n >= 1 && n <= MAX_CPUS);
+    for (i = 1; i < n; i++) {
+	readyQueue = new NachOSscheduler();
+	readyQueue->alpha = scheduler->alpha;
+	readyQueue->adaptiveAlpha = scheduler->adaptiveAlpha;
+	readyQueue->agingRate = scheduler->agingRate;
+	readyQueue->dispatchTableFile = scheduler->dispatchTableFile;
+	readyQueue->SetPolicy(scheduler->schedulerCode,
+		scheduler->groupScheduling);
+	processors[i] = new Processor(i, readyQueue);
+    }
+    numCPUs = n;
+    stats->num_cpus = n;
+    if (n == 1)
+	return;
+
+    // The idle threads are nobody's children, and nobody waits for them
+    currentThread = NULL;
+    for (i = 0; i < n; i++) {
+	idle = new NachOSThread("idle");
+	pidTable->Exited(idle->GetPID());
+	idle->AllocateThreadStack(IdleLoop, i);
+	processors[i]->idleThread = idle;
+	processors[i]->thread = idle;
+    }
+    currentThread = mainThread;
+    processors[0]->thread = mainThread;
+}
@@ -0,0 +1,81 @@
+// processor.h
+//	Data structures for simulating a shared-memory multiprocessor.
+//
+//	With "-ncpu N", Nachos simulates N MIPS CPUs sharing mainMemory.
+//	Each CPU has its own register file and page table register, its
+//	own running thread, its own ready queue (a NachOSscheduler), and
+//	an idle thread that runs when it has nothing else to do.
+//
+//	There is still only one host thread of control, so the CPUs are
+//	run in lock step: each CPU executes one user instruction in turn,
+//	by switching to the thread that CPU is running, and simulated time
+//	advances by one tick when every CPU has had its turn.  Kernel code
+//	is not interleaved; while one CPU is in the kernel the others
+//	stand still, as if the kernel were protected by a single lock.
+//
+//	A CPU that runs out of work steals a thread from the CPU with the
+//	most ready threads.  The timer interrupt is delivered to every CPU,
+//	and each CPU decides with its own scheduler whether to preempt
+//	its running thread.  A policy that gives each dispatch a slice of
+//	its own cannot reprogram the shared timer; the CPU keeps the end of
+//	the slice instead, and checks the thread when it comes.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROCESSOR_H
+#define PROCESSOR_H
+
+#include "copyright.h"
+#include "thread.h"
+#include "scheduler.h"
+#include "interrupt.h"
+
+// The following class defines the state of one simulated CPU.
+// While a CPU is being simulated, its registers and page table are
+// the ones in "machine", its thread is "currentThread", and its ready
+// queue is "scheduler"; the copies here of the registers, page table
+// and thread are only valid while some other CPU is being simulated.
+
+class Processor {
+  public:
+    Processor(int cpuId, NachOSscheduler *cpuQueue);
+					// initialize CPU "id"
+
+    void SaveState();			// save the CPU's state on switching
+					// to another CPU
+    void RestoreState();		// make the CPU the one being simulated
+    void StartSlice(int quantum);	// a thread was dispatched for
+					// "quantum" ticks, 0 if the shared
+					// timer decides
+    bool ShouldPreempt(NachOSThread *running);
+					// has "running" used up its slice?
+
+    int id;
+    NachOSscheduler *readyQueue;	// this CPU's scheduler
+    NachOSThread *thread;		// thread running on this CPU
+    NachOSThread *idleThread;		// runs when the ready queue is empty
+    MachineStatus status;		// user, kernel or idle mode
+    bool preemptPending;		// timer asked for a reschedule
+    int sliceEnd;			// when the running thread's slice is
+					// up, 0 if it has none
+
+#ifdef USER_PROGRAM
+    int registers[NumTotalRegs];	// register file
+    TranslationEntry *pageTable;	// page table register
+    unsigned int pageTableSize;
+#endif
+};
+
+extern void StartProcessors(int n);	// set up CPUs 1..n-1 and the idle
+					// threads
+extern void ProcessorTick();		// a CPU finished an instruction:
+					// run the others, then come back
+extern void PreemptProcessors();	// timer interrupt, on every CPU
+extern NachOSThread *StealThread();	// take a ready thread from the
+					// busiest other CPU, NULL if none
+extern NachOSThread *IdleThread();	// the current CPU's idle thread,
+					// NULL on a uniprocessor
+
+#endif // PROCESSOR_H
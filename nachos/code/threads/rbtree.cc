@@ -0,0 +1,385 @@
+// rbtree.cc
+//	Routines to manage a red-black tree of "things".
+//
+//	The rebalancing follows the usual textbook presentation
+//	(Cormen et al., "Introduction to Algorithms", ch. 13), with a
+//	sentinel nil node standing in for every leaf.
+//
+//	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "rbtree.h"
+
+//----------------------------------------------------------------------
+// RBTree::RBTree
+//	Initialize a tree, empty to start with.
+//----------------------------------------------------------------------
+
+RBTree::RBTree()
+{
+    nil = new RBNode;
+    nil->item = NULL;
+    nil->red = false;
+    nil->left = nil->right = nil->parent = nil;
+    root = leftmost = nil;
+    numInTree = 0;
+    nextSeq = 0;
+}
+
+//----------------------------------------------------------------------
+// RBTree::~RBTree
+//	De-allocate the tree.  As with List, the items themselves are
+//	not de-allocated.
+//----------------------------------------------------------------------
+
+RBTree::~RBTree()
+{
+    while (RemoveMin(NULL) != NULL)
+	;
+    delete nil;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Less
+//	Order nodes by key, then by insertion order.
+//----------------------------------------------------------------------
+
+bool
+RBTree::Less(RBNode *a, RBNode *b)
+{
+    if (a->key != b->key)
+	return (a->key < b->key);
+    return ((int)(a->seq - b->seq) < 0);
+}
+
+//----------------------------------------------------------------------
+// RBTree::RotateLeft, RBTree::RotateRight
+//	Rotate the subtree rooted at "x", keeping the in-order sequence.
+//----------------------------------------------------------------------
+
+void
+RBTree::RotateLeft(RBNode *x)
+{
+    RBNode *y = x->right;
+
+    x->right = y->left;
+    if (y->left != nil)
+	y->left->parent = x;
+    y->parent = x->parent;
+    if (x->parent == nil)
+	root = y;
+    else if (x == x->parent->left)
+	x->parent->left = y;
+    else
+	x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}
+
+void
+RBTree::RotateRight(RBNode *x)
+{
+    RBNode *y = x->left;
+
+    x->left = y->right;
+    if (y->right != nil)
+	y->right->parent = x;
+    y->parent = x->parent;
+    if (x->parent == nil)
+	root = y;
+    else if (x == x->parent->right)
+	x->parent->right = y;
+    else
+	x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Insert
+//	Put "item" into the tree with key "key".
+//----------------------------------------------------------------------
+
+void
+RBTree::Insert(void *item, double key)
+{
+    RBNode *z = new RBNode;
+    RBNode *y = nil;
+    RBNode *x = root;
+
+    z->item = item;
+    z->key = key;
+    z->seq = nextSeq++;
+    z->left = z->right = nil;
+    z->red = true;
+
+    while (x != nil) {
+	y = x;
+	x = Less(z, x) ? x->left : x->right;
+    }
+    z->parent = y;
+    if (y == nil)
+	root = z;
+    else if (Less(z, y))
+	y->left = z;
+    else
+	y->right = z;
+
+    if (leftmost == nil || Less(z, leftmost))
+	leftmost = z;
+    numInTree++;
+    InsertFixup(z);
+}
+
+//----------------------------------------------------------------------
+// RBTree::InsertFixup
+//	Restore the red-black properties after inserting the red node "z".
+//----------------------------------------------------------------------
+
+void
+RBTree::InsertFixup(RBNode *z)
+{
+    RBNode *y;
+
+    while (z->parent->red) {
+	if (z->parent == z->parent->parent->left) {
+	    y = z->parent->parent->right;
+	    if (y->red) {
+		z->parent->red = false;
+		y->red = false;
+		z->parent->parent->red = true;
+		z = z->parent->parent;
+	    } else {
+		if (z == z->parent->right) {
+		    z = z->parent;
+		    RotateLeft(z);
+		}
+		z->parent->red = false;
+		z->parent->parent->red = true;
+		RotateRight(z->parent->parent);
+	    }
+	} else {
+	    y = z->parent->parent->left;
+	    if (y->red) {
+		z->parent->red = false;
+		y->red = false;
+		z->parent->parent->red = true;
+		z = z->parent->parent;
+	    } else {
+		if (z == z->parent->left) {
+		    z = z->parent;
+		    RotateRight(z);
+		}
+		z->parent->red = false;
+		z->parent->parent->red = true;
+		RotateLeft(z->parent->parent);
+	    }
+	}
+    }
+    root->red = false;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Transplant
+//	Replace the subtree rooted at "u" with the one rooted at "v".
+//----------------------------------------------------------------------
+
+void
+RBTree::Transplant(RBNode *u, RBNode *v)
+{
+    if (u->parent == nil)
+	root = v;
+    else if (u == u->parent->left)
+	u->parent->left = v;
+    else
+	u->parent->right = v;
+    v->parent = u->parent;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Successor
+//	Return the node after "x" in key order, nil if "x" is the last.
+//----------------------------------------------------------------------
+
+RBNode *
+RBTree::Successor(RBNode *x)
+{
+    RBNode *y;
+
+    if (x->right != nil) {
+	x = x->right;
+	while (x->left != nil)
+	    x = x->left;
+	return x;
+    }
+    y = x->parent;
+    while (y != nil && x == y->right) {
+	x = y;
+	y = y->parent;
+    }
+    return y;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Delete
+//	Unlink the node "z" from the tree and free it.
+//----------------------------------------------------------------------
+
+void
+RBTree::Delete(RBNode *z)
+{
+    RBNode *y = z;
+    RBNode *x;
+    bool yWasRed = y->red;
+
+    if (z == leftmost)
+	leftmost = Successor(z);
+
+    if (z->left == nil) {
+	x = z->right;
+	Transplant(z, z->right);
+    } else if (z->right == nil) {
+	x = z->left;
+	Transplant(z, z->left);
+    } else {
+	y = z->right;
+	while (y->left != nil)
+	    y = y->left;
+	yWasRed = y->red;
+	x = y->right;
+	if (y->parent == z)
+	    x->parent = y;
+	else {
+	    Transplant(y, y->right);
+	    y->right = z->right;
+	    y->right->parent = y;
+	}
+	Transplant(z, y);
+	y->left = z->left;
+	y->left->parent = y;
+	y->red = z->red;
+    }
+    if (!yWasRed)
+	DeleteFixup(x);
+
+    delete z;
+    numInTree--;
+}
+
+//----------------------------------------------------------------------
+// RBTree::DeleteFixup
+//	Restore the red-black properties after removing a black node;
+//	"x" carries the extra black.
+//----------------------------------------------------------------------
+
+void
+RBTree::DeleteFixup(RBNode *x)
+{
+    RBNode *w;
+
+    while (x != root && !x->red) {
+	if (x == x->parent->left) {
+	    w = x->parent->right;
+	    if (w->red) {
+		w->red = false;
+		x->parent->red = true;
+		RotateLeft(x->parent);
+		w = x->parent->right;
+	    }
+	    if (!w->left->red && !w->right->red) {
+		w->red = true;
+		x = x->parent;
+	    } else {
+		if (!w->right->red) {
+		    w->left->red = false;
+		    w->red = true;
+		    RotateRight(w);
+		    w = x->parent->right;
+		}
+		w->red = x->parent->red;
+		x->parent->red = false;
+		w->right->red = false;
+		RotateLeft(x->parent);
+		x = root;
+	    }
+	} else {
+	    w = x->parent->left;
+	    if (w->red) {
+		w->red = false;
+		x->parent->red = true;
+		RotateRight(x->parent);
+		w = x->parent->left;
+	    }
+	    if (!w->right->red && !w->left->red) {
+		w->red = true;
+		x = x->parent;
+	    } else {
+		if (!w->left->red) {
+		    w->right->red = false;
+		    w->red = true;
+		    RotateLeft(w);
+		    w = x->parent->left;
+		}
+		w->red = x->parent->red;
+		x->parent->red = false;
+		w->left->red = false;
+		RotateRight(x->parent);
+		x = root;
+	    }
+	}
+    }
+    x->red = false;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Min
+//	Return the item with the smallest key, without removing it.
+//	NULL if the tree is empty.  If "keyPtr" is not NULL, the key
+//	of the item is stored there.
+//----------------------------------------------------------------------
+
+void *
+RBTree::Min(double *keyPtr)
+{
+    if (IsEmpty())
+	return NULL;
+    if (keyPtr != NULL)
+	*keyPtr = leftmost->key;
+    return leftmost->item;
+}
+
+//----------------------------------------------------------------------
+// RBTree::RemoveMin
+//	Remove the item with the smallest key from the tree.
+//
+// Returns:
+//	Pointer to removed item, NULL if the tree is empty.
+//	Sets *keyPtr (if not NULL) to the key of the removed item.
+//----------------------------------------------------------------------
+
+void *
+RBTree::RemoveMin(double *keyPtr)
+{
+    void *thing = Min(keyPtr);
+
+    if (thing == NULL)
+	return NULL;
+    Delete(leftmost);
+    return thing;
+}
+
+//----------------------------------------------------------------------
+// RBTree::Mapcar
+//	Apply a function to each item in the tree, in key order.
+//----------------------------------------------------------------------
+
+void
+RBTree::Mapcar(VoidFunctionPtr func)
+{
+    for (RBNode *x = leftmost; x != nil; x = Successor(x))
+	(*func)((int)x->item);
+}
@@ -0,0 +1,73 @@
+// rbtree.h
+//	Data structures for a red-black tree ordered by key.
+//
+//	Like a Heap, an RBTree holds any type of item ("void *") with a
+//	floating-point key, and items with equal keys come out in the
+//	order they were inserted.  Unlike a Heap, the tree is kept fully
+//	sorted, so it can be walked in key order, and the leftmost
+//	(smallest) node is cached so that Min is O(1).
+//
+//	Insert and RemoveMin are O(log n), with at most three rotations
+//	per operation.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// One node of the tree.  Every leaf pointer refers to the tree's
+// shared black "nil" node rather than NULL, which keeps the
+// rebalancing code free of special cases.
+
+class RBNode {
+  public:
+    void *item;			// pointer to item in the tree
+    double key;			// sort key, smallest first
+    unsigned seq;		// insertion order, for FIFO ties
+    bool red;			// node color
+    RBNode *left;
+    RBNode *right;
+    RBNode *parent;
+};
+
+// The following class defines a red-black tree of items, ordered by key.
+
+class RBTree {
+  public:
+    RBTree();			// initialize an empty tree
+    ~RBTree();			// de-allocate the tree (not the items)
+
+    void Insert(void *item, double key);	// Put item into tree
+    void *RemoveMin(double *keyPtr);	// Remove smallest item, NULL if
+					// empty; its key goes to *keyPtr
+    void *Min(double *keyPtr);		// Same, without removing it
+
+    bool IsEmpty() { return (numInTree == 0); }
+    int NumInTree() { return numInTree; }
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every item,
+					// smallest key first
+
+  private:
+    bool Less(RBNode *a, RBNode *b);	// Does a come before b?
+    void RotateLeft(RBNode *x);
+    void RotateRight(RBNode *x);
+    void InsertFixup(RBNode *z);
+    void Transplant(RBNode *u, RBNode *v);
+    void Delete(RBNode *z);
+    void DeleteFixup(RBNode *x);
+    RBNode *Successor(RBNode *x);
+
+    RBNode *root;
+    RBNode *nil;			// shared black leaf
+    RBNode *leftmost;			// smallest node, nil if empty
+    int numInTree;
+    unsigned nextSeq;			// sequence number of next Insert
+};
+
+#endif // RBTREE_H
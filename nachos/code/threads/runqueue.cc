@@ -0,0 +1,191 @@
+// runqueue.cc
+//	Routines to manage the constant-time priority ready queue.
+//
+//	Each non-empty level has its bit set in levelMap, and each
+//	non-zero word of levelMap has its bit set in wordMap.  With
+//	NUM_PRIORITY_LEVELS at most 32*32, locating the best level is
+//	two ffs() calls.
+//
+//	NOTE: Mutual exclusion must be provided by the caller; the
+//	scheduler only touches the queue with interrupts disabled.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include <strings.h>
+
+#include "copyright.h"
+#include "runqueue.h"
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::PriorityRunQueue
+//	Initialize the queue, empty to start with.
+//----------------------------------------------------------------------
+
+PriorityRunQueue::PriorityRunQueue()
+{
+    int i;
+
+    ASSERT(NUM_PRIORITY_WORDS <= PRIORITY_WORD_BITS);
+    for (i = 0; i < NUM_PRIORITY_LEVELS; i++)
+	head[i] = tail[i] = NULL;
+    for (i = 0; i < NUM_PRIORITY_WORDS; i++)
+	levelMap[i] = 0;
+    wordMap = 0;
+    numInQueue = 0;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::~PriorityRunQueue
+//	Prepare the queue for deallocation.  The threads themselves are
+//	not ours to delete; just unlink them.
+//----------------------------------------------------------------------
+
+PriorityRunQueue::~PriorityRunQueue()
+{
+    while (RemoveMin() != NULL)
+	;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::LevelOf
+//	Map a priority value to a level index.  Out-of-range values are
+//	clamped to the first or last level.
+//----------------------------------------------------------------------
+
+int
+PriorityRunQueue::LevelOf(int priority)
+{
+    if (priority < 0)
+	return 0;
+    if (priority >= NUM_PRIORITY_LEVELS)
+	return NUM_PRIORITY_LEVELS - 1;
+    return priority;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::FirstLevel
+//	Return the lowest-numbered non-empty level, or -1 if the queue
+//	is empty.
+//----------------------------------------------------------------------
+
+int
+PriorityRunQueue::FirstLevel()
+{
+    int word, bit;
+
+    if (wordMap == 0)
+	return -1;
+    word = ffs((int) wordMap) - 1;
+    bit = ffs((int) levelMap[word]) - 1;
+    return word * PRIORITY_WORD_BITS + bit;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::Insert
+//	Append "thread" to the tail of the level for "priority", linked
+//	through "link", which must not be on a queue already.
+//----------------------------------------------------------------------
+
+void
+PriorityRunQueue::Insert(NachOSThread *thread, RunQueueLink *link, int priority)
+{
+    int level = LevelOf(priority);
+    int word = level / PRIORITY_WORD_BITS;
+
+    ASSERT(link->level == -1);
+    link->thread = thread;
+    link->level = level;
+    link->next = NULL;
+    link->prev = tail[level];
+    if (tail[level] == NULL)
+	head[level] = link;
+    else
+	tail[level]->next = link;
+    tail[level] = link;
+
+    levelMap[word] |= (1u << (level % PRIORITY_WORD_BITS));
+    wordMap |= (1u << word);
+    numInQueue++;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::Remove
+//	Unlink the thread of "link" from whichever level it is on.
+//----------------------------------------------------------------------
+
+void
+PriorityRunQueue::Remove(RunQueueLink *link)
+{
+    int level = link->level;
+    int word = level / PRIORITY_WORD_BITS;
+
+    ASSERT(level >= 0);
+    if (link->prev == NULL)
+	head[level] = link->next;
+    else
+	link->prev->next = link->next;
+    if (link->next == NULL)
+	tail[level] = link->prev;
+    else
+	link->next->prev = link->prev;
+
+    if (head[level] == NULL) {
+	levelMap[word] &= ~(1u << (level % PRIORITY_WORD_BITS));
+	if (levelMap[word] == 0)
+	    wordMap &= ~(1u << word);
+    }
+    link->next = link->prev = NULL;
+    link->level = -1;
+    numInQueue--;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::Min
+//	Return the first thread on the best non-empty level, without
+//	removing it.  NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+NachOSThread *
+PriorityRunQueue::Min()
+{
+    int level = FirstLevel();
+
+    if (level < 0)
+	return NULL;
+    return head[level]->thread;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::RemoveMin
+//	Remove and return the first thread on the best non-empty level.
+//	NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+NachOSThread *
+PriorityRunQueue::RemoveMin()
+{
+    int level = FirstLevel();
+    NachOSThread *thread;
+
+    if (level < 0)
+	return NULL;
+    thread = head[level]->thread;
+    Remove(head[level]);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// PriorityRunQueue::Mapcar
+//	Apply a function to each thread on the queue, best level first.
+//	Linear in the number of levels; for debugging only.
+//----------------------------------------------------------------------
+
+void
+PriorityRunQueue::Mapcar(VoidFunctionPtr func)
+{
+    for (int level = 0; level < NUM_PRIORITY_LEVELS; level++)
+	for (RunQueueLink *link = head[level]; link != NULL; link = link->next)
+	    (*func)((int) link->thread);
+}
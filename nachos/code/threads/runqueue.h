@@ -0,0 +1,78 @@
+// runqueue.h
+//	Data structures for a constant-time priority ready queue.
+//
+//	The ready threads are kept in an array of FIFO queues, one per
+//	priority level, together with a two-level bitmap recording which
+//	levels are non-empty.  Finding the best (numerically smallest)
+//	priority is then two find-first-set operations, independent of
+//	the number of ready threads.
+//
+//	The queues are linked through a RunQueueLink that the policy keeps
+//	in its record of each thread, so a thread can be unlinked from the
+//	middle of its level in constant time when its priority is
+//	recomputed while it is waiting.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef RUNQUEUE_H
+#define RUNQUEUE_H
+
+#include "copyright.h"
+#include "thread.h"
+
+// Priority values at or above NUM_PRIORITY_LEVELS-1 share the last
+// level (FIFO among themselves).  UNIX priorities are base (50 + 0..100)
+// plus half the decayed CPU usage, so in practice only threads with a
+// very long single burst (e.g. the main thread loading a batch) land there.
+#define NUM_PRIORITY_LEVELS	512
+#define PRIORITY_WORD_BITS	32
+#define NUM_PRIORITY_WORDS	(NUM_PRIORITY_LEVELS / PRIORITY_WORD_BITS)
+
+// A thread's place on a PriorityRunQueue.
+
+class RunQueueLink {
+  public:
+    RunQueueLink() { thread = NULL; next = prev = NULL; level = -1; }
+
+    NachOSThread *thread;		// the thread, while it is queued
+    RunQueueLink *next;			// neighbours on its level
+    RunQueueLink *prev;
+    int level;				// -1 if not on a PriorityRunQueue
+};
+
+// The following class defines a ready queue ordered by an integer
+// priority, lower value first, FIFO among equal priorities.
+
+class PriorityRunQueue {
+  public:
+    PriorityRunQueue();			// initialize an empty queue
+    ~PriorityRunQueue();		// de-allocate the queue
+
+    void Insert(NachOSThread *thread, RunQueueLink *link, int priority);
+					// Put thread, linked through "link",
+					// at the tail of its level
+    void Remove(RunQueueLink *link);	// Unlink a thread from its level
+    NachOSThread *RemoveMin();		// Take the first thread off the
+					// best non-empty level, NULL if none
+    NachOSThread *Min();		// Same, without removing it
+
+    bool IsEmpty() { return (numInQueue == 0); }
+    int NumInQueue() { return numInQueue; }
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every thread,
+					// best level first
+
+  private:
+    int LevelOf(int priority);		// Clamp priority into a level
+    int FirstLevel();			// Best non-empty level, -1 if none
+
+    RunQueueLink *head[NUM_PRIORITY_LEVELS];	// first thread on each level
+    RunQueueLink *tail[NUM_PRIORITY_LEVELS];	// last thread on each level
+    unsigned levelMap[NUM_PRIORITY_WORDS];	// bit set if level non-empty
+    unsigned wordMap;			// bit set if levelMap word non-zero
+    int numInQueue;
+};
+
+#endif // RUNQUEUE_H
@@ -0,0 +1,160 @@
+// schedbench.cc
+//	A standalone benchmark of the scheduler's ready queues, built with
+//	"gmake schedbench" in this directory.
+//
+//	It links the scheduler, the policies and their queues, and nothing
+//	of the machine: there are no interrupts, no timer and no context
+//	switches, and the threads are stubs that only carry the fields the
+//	policies read.  So the numbers are the host time of the ready-queue
+//	code alone, and can be compared from one change of it to the next.
+//
+//	For every schedulerCode and for 1 to 10000 ready threads, it times
+//	a pick (FindNextThreadToRun) followed by putting the thread back
+//	(ThreadIsReadyToRun), and prints the nanoseconds per pair as CSV.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+
+#define BENCH_POLICIES		19	// schedulerCodes 1 to this
+#define BENCH_MAX_DEPTH		10000	// most ready threads
+#define BENCH_BATCH		1000	// pairs timed between clock reads
+#define BENCH_MIN_TIME		0.02	// seconds to time each point for
+
+// The globals the scheduler and the policies use; system.cc, which
+// defines them in Nachos, is not linked in.
+
+NachOSThread *currentThread = NULL;
+NachOSThread *threadToBeDestroyed = NULL;
+NachOSscheduler *scheduler;
+Interrupt *interrupt = NULL;
+Statistics *stats;
+Timer *timer;
+BurstHistory *burstHistory = NULL;
+TraceRecorder *traceRecorder = NULL;
+int numCPUs = 1;
+int currentCPU = 0;
+Processor *processors[MAX_CPUS];
+int NachOSThread::numThreads = 0;
+
+//----------------------------------------------------------------------
+// Stubs
+//	Stand-ins for the parts of Nachos that the scheduler can reach
+//	but the benchmark never gets to: nothing runs, so no thread is
+//	ever switched to, preempted or destroyed while running.
+//----------------------------------------------------------------------
+
+NachOSThread *IdleThread() { return NULL; }
+void Interrupt::YieldOnReturn() {}
+void Timer::Reprogram(int ticks) {}
+void Processor::StartSlice(int quantum) {}
+void NachOSThread::CheckOverflow() {}
+double BurstHistory::ExpectedBurst(NachOSThread *thread) { return 0.0; }
+void BurstHistory::Learn(NachOSThread *thread, double expectedBurst) {}
+void TraceRecorder::Arrived(NachOSThread *thread) {}
+void TraceRecorder::Ran(NachOSThread *thread, int burst) {}
+void TraceRecorder::Woken(NachOSThread *thread) {}
+void TraceRecorder::Exited(NachOSThread *thread) {}
+void ThreadPrint(int arg) { ((NachOSThread *)arg)->Print(); }
+void _SWITCH(NachOSThread *oldThread, NachOSThread *newThread) {}
+
+//----------------------------------------------------------------------
+// NachOSThread::NachOSThread
+//	A thread that can only be queued: no stack, no parent, and a pid
+//	of its own numbering instead of one from the pid table.  Like a
+//	batch job of priority "newPriority" (see thread.cc), it has no
+//	scheduling state until a policy admits it; all of it is zero but
+//	the following.
+//----------------------------------------------------------------------
+
+NachOSThread::NachOSThread(char *threadName, int newPriority)
+{
+    memset((void *)this, 0, sizeof(NachOSThread));
+    name = threadName;
+    status = JUST_CREATED;
+    pid = ++numThreads;
+    ppid = -1;
+    batchPriority = newPriority;
+    curr_wait_start = stats->totalTicks;
+}
+
+NachOSThread::~NachOSThread()
+{
+    delete schedState;
+}
+
+//----------------------------------------------------------------------
+// TimePairs
+//	Return the host nanoseconds of one pick and requeue, under the
+//	policy "scheduler" runs, with "n" threads ready.  Each picked
+//	thread is dispatched and put straight back, as after a yield.
+//	Batches of pairs run until BENCH_MIN_TIME has passed.
+//----------------------------------------------------------------------
+
+static double
+TimePairs(NachOSThread **threads, int n)
+{
+    NachOSThread *t;
+    double start, elapsed;
+    int i, pairs = 0;
+
+    for (i = 0; i < n; i++)
+	scheduler->ThreadIsReadyToRun(threads[i]);
+
+    start = HostTime();
+    do {
+	for (i = 0; i < BENCH_BATCH; i++) {
+	    t = scheduler->FindNextThreadToRun();
+	    t->setStatus(RUNNING);
+	    stats->totalTicks++;
+	    scheduler->ThreadIsReadyToRun(t);
+	}
+	pairs += BENCH_BATCH;
+	elapsed = HostTime() - start;
+    } while (elapsed < BENCH_MIN_TIME);
+
+    while (scheduler->FindNextThreadToRun() != NULL)
+	;
+    return elapsed * 1e9 / pairs;
+}
+
+//----------------------------------------------------------------------
+// main
+//	Run TimePairs for every policy at every depth, with a fresh
+//	scheduler and fresh threads each time, and print a CSV table.
+//	The time-sharing policy reads "dispatch_table" as Nachos would.
+//----------------------------------------------------------------------
+
+int
+main(int argc, char **argv)
+{
+    static int depths[] = { 1, 10, 100, 1000, 10000 };
+    NachOSThread **threads = new NachOSThread*[BENCH_MAX_DEPTH];
+    int code, d, i, n;
+
+    RandomInit(1);
+    stats = new Statistics();
+
+    printf("schedulerCode, ready threads, ns per ready + pick\n");
+    for (code = 1; code <= BENCH_POLICIES; code++) {
+	for (d = 0; d < (int)(sizeof(depths) / sizeof(depths[0])); d++) {
+	    n = depths[d];
+	    ASSERT(n <= BENCH_MAX_DEPTH);
+	    scheduler = new NachOSscheduler();
+	    scheduler->SetPolicy(code, FALSE);
+	    for (i = 0; i < n; i++)
+		threads[i] = new NachOSThread("bench", Random() % 101);
+	    printf("%d, %d, %.1f\n", code, n, TimePairs(threads, n));
+	    fflush(stdout);
+	    for (i = 0; i < n; i++)
+		delete threads[i];
+	    delete scheduler;
+	}
+    }
+    delete [] threads;
+    delete stats;
+    return 0;
+}
@@ -11,8 +11,9 @@
 //	end up calling FindNextThreadToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	The scheduling decisions themselves are left to a SchedulingPolicy
+//	(policy.cc), chosen by schedulerCode; the scheduler keeps what is
+//	common to all policies.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -25,21 +26,21 @@
 //----------------------------------------------------------------------
 // NachOSscheduler::NachOSscheduler
 // 	Initialize the list of ready but not running threads to empty.
+//	Until told otherwise, threads run first-come first-served.
 //----------------------------------------------------------------------
 
 NachOSscheduler::NachOSscheduler()
 { 
-    readyThreadList = new List;
+    numReady = 0;
 
     //SJF
     alpha = 0.5;
+    adaptiveAlpha = false;
+    agingRate = 0.0;
+    dispatchTableFile = DISPATCH_TABLE_FILE;
 
-    quantum = 0;
-
-    int i;
-    for (i=0; i < MAX_THREAD_COUNT; i++) {
-        cpuCount[i] = 0;
-    } 
+    policy = NULL;
+    SetPolicy(1, FALSE);
 } 
 
 //----------------------------------------------------------------------
@@ -49,9 +50,30 @@ NachOSscheduler::NachOSscheduler()
 
 NachOSscheduler::~NachOSscheduler()
 { 
-    delete readyThreadList; 
+    delete policy;
 } 
 
+//----------------------------------------------------------------------
+// NachOSscheduler::SetPolicy
+// 	Switch to the scheduling policy of schedulerCode "code", or, if
+//	"byGroup", to fair sharing between job groups with that policy
+//	within each group.  The policy's queue goes with it, so no thread
+//	may be ready.
+//----------------------------------------------------------------------
+
+void
+NachOSscheduler::SetPolicy (int code, bool byGroup)
+{
+    ASSERT(numReady == 0);
+    delete policy;
+    if (byGroup)
+        policy = new GroupFairPolicy(this, code);
+    else
+        policy = NewSchedulingPolicy(this, code);
+    schedulerCode = code;
+    groupScheduling = byGroup;
+}
+
 //----------------------------------------------------------------------
 // NachOSscheduler::ThreadIsReadyToRun
 // 	Mark a thread as ready, but not running.
@@ -65,29 +87,52 @@ NachOSscheduler::ThreadIsReadyToRun (NachOSThread *thread)
 {
     DEBUG('t', "Putting thread %s with PID %d on ready list.\n", thread->getName(), thread->GetPID());
 
+    ThreadStatus oldStatus = thread->getStatus();
     thread->setStatus(READY);
     thread->curr_wait_start=stats->totalTicks;
-    
-    // SJF and non zero cpu burst
-    if (schedulerCode == 2 && thread->prev_cpu_burst > 0) {
-        double expected_cpu_burst = alpha * thread->prev_cpu_burst + (1 - alpha) * thread->prev_expected_cpu_burst;
-
-        int error = thread->prev_cpu_burst - expected_cpu_burst;
-
-        if (error < 0)
-            error = -1 * error;
-
-        // TODO: report stats-error
+    thread->woken = (oldStatus == BLOCKED);
+    if (traceRecorder != NULL) {
+        if (oldStatus == JUST_CREATED)
+            traceRecorder->Arrived(thread);
+        else if (oldStatus == BLOCKED)
+            traceRecorder->Woken(thread);
+    }
+    numReady++;
+    policy->ThreadReady(thread, oldStatus);
+    if (oldStatus == BLOCKED)
+        PreemptOnWakeup();
+}
 
-        //update prev_expected_cpu_burst
-        thread->prev_expected_cpu_burst = expected_cpu_burst;
+//----------------------------------------------------------------------
+// NachOSscheduler::PreemptOnWakeup
+// 	Called when a thread that was blocked -- on a sleep, a Join, a
+//	semaphore -- has been put on the ready queue.  If the policy says
+//	it should run before the running thread, preempt at the next safe
+//	point: on return from the interrupt handler that woke it, or, on
+//	a multiprocessor, after the CPU's current instruction.  Otherwise
+//	the request stays pending: the system call that woke it acts on it
+//	as it returns (see ExceptionHandler), and failing that the next
+//	timer interrupt does.
+//
+//	The running thread is not charged with a used-up quantum (yieldAt
+//	is left alone): under MLFQ it keeps its level.
+//----------------------------------------------------------------------
 
-        // Insert the thread into the List using expected_cpu_burst
-        readyThreadList->SortedInsert((void*)thread, expected_cpu_burst);
-    }
-    else {
-        //printf("pid of thread = %d\n", thread->GetPID());
-        readyThreadList->Append((void *)thread);
+void
+NachOSscheduler::PreemptOnWakeup ()
+{
+    if (currentThread == NULL || currentThread == IdleThread())
+        return;
+    if (numCPUs > 1) {
+        if (policy->PreemptPending()) {
+            processors[currentCPU]->preemptPending = true;
+            stats->wakeup_preemptions++;
+        }
+    } else if (interrupt->InHandler()) {
+        if (policy->PreemptPending()) {
+            interrupt->YieldOnReturn();
+            stats->wakeup_preemptions++;
+        }
     }
 }
 
@@ -96,73 +141,242 @@ NachOSscheduler::ThreadIsReadyToRun (NachOSThread *thread)
 // 	Return the next thread to be scheduled onto the CPU.
 //	If there are no ready threads, return NULL.
 // Side effect:
-//	Thread is removed from the ready list.
+//	Thread is removed from the ready list, and the time it waited
+//	there goes to the statistics.
 //----------------------------------------------------------------------
 
 NachOSThread *
 NachOSscheduler::FindNextThreadToRun ()
 {
-    // default except for UNIX scheduling
-    if (schedulerCode <= 6)
-        return (NachOSThread *)readyThreadList->Remove();
-    else {
-        // if readyThreadList is empty return NULL
-        if (readyThreadList->first == NULL)
-            return NULL;
-
-        // get the thread with minimum priority value
-        // scan the entire readyThreadList and update minElementPtr accordingly
-        ListElement *minElementPtr = readyThreadList->first;
-
-        // temp variables are used to iterate through the readyThreadList
-        ListElement *tempElementPtr = minElementPtr;
-        NachOSThread *tempThreadPtr = (NachOSThread*)minElementPtr->item;
-        int tempPriorityValue = tempThreadPtr->priority;
-
-        NachOSThread *minThreadPtr = tempThreadPtr;
-        int minPriorityValue =  minThreadPtr->priority;
-
-        // iterate through readyThreadList
-        while (tempElementPtr != NULL) {
-            tempThreadPtr = (NachOSThread*)tempElementPtr->item;
-            tempPriorityValue = tempThreadPtr->priority;
-
-            if (tempPriorityValue < minPriorityValue) {
-                minElementPtr = tempElementPtr;
-                minThreadPtr = tempThreadPtr;
-                minPriorityValue = tempPriorityValue;
-            }
-            tempElementPtr = tempElementPtr->next;
-        }
+    NachOSThread *thread = policy->PickNext();
 
-        // remove the min element from readyThreadList
-        tempElementPtr = readyThreadList->first;
-        
-        // if the minThread is the first then directly use default Remove()
-        if (tempElementPtr == minElementPtr) {
-            return (NachOSThread *)readyThreadList->Remove();
-        }
+    if (thread != NULL) {
+        numReady--;
+        if (thread->GetPID() > 0) {
+            int wait = stats->totalTicks - thread->curr_wait_start;
 
-        ListElement *prevElementPtr = tempElementPtr;
-        tempElementPtr = tempElementPtr->next;
-        while(tempElementPtr != NULL) {
-            if(tempElementPtr == minElementPtr) {
-                prevElementPtr->next = tempElementPtr->next;
-
-                // if the min is last then update readyThreadList last as prevElementPtr
-                if (tempElementPtr == readyThreadList->last) {
-                    readyThreadList->last = prevElementPtr;
-                }
-            }
-            prevElementPtr = tempElementPtr;
-            tempElementPtr = tempElementPtr->next;
+            stats->RecordWait(wait);
+            if (thread->woken)
+                stats->RecordWakeLatency(wait);
         }
+        thread->woken = false;
+    }
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::Migrate
+// 	Called on the scheduler of an idle CPU that has stolen "thread"
+//	from the ready queue of "from".  Scheduling state that is relative
+//	to a ready queue moves with the thread: its UNIX decay epoch, its
+//	share of the stride tickets, its CFS load and its virtual runtime
+//	relative to the queue's minimum.  All CPUs run the same policy.
+//----------------------------------------------------------------------
+
+void
+NachOSscheduler::Migrate (NachOSThread *thread, NachOSscheduler *from)
+{
+    ASSERT(schedulerCode == from->schedulerCode);
+    policy->Migrated(thread, from->policy);
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::EndBurst
+// 	Called by a thread that is giving up the CPU -- because it yields,
+//	blocks, or exits -- with the length of the burst it just ran.
+//	The thread's status is already BLOCKED if it will not be ready
+//	again.  A periodic deadline job that blocks has finished an
+//	instance; then the policy charges the burst as it sees fit.  With
+//	-trace, the burst is written once the thread wakes or exits.
+//
+//	"thread" is the thread whose burst ended.
+//	"burst" is the length of the burst, in ticks.
+//----------------------------------------------------------------------
+
+void
+NachOSscheduler::EndBurst (NachOSThread *thread, int burst)
+{
+    // A periodic job has finished its current instance when it blocks
+    if (thread->deadlineJob != NULL && thread->deadlineJob->period > 0
+            && thread->getStatus() == BLOCKED)
+        EndInstance(thread);
+
+    policy->BurstEnded(thread, burst);
+    if (traceRecorder != NULL)
+        traceRecorder->Ran(thread, burst);
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::AdmitDeadline
+// 	EDF admission control, called before a deadline job is created.
+//	Return FALSE if the policy cannot take on a job that needs
+//	"utilization" of the CPU; then the job must not be run.  Only EDF
+//	makes guarantees, the other policies admit everything.  "group" is
+//	the job's fair-share group; under group scheduling each group
+//	admits its own deadline jobs.
+//----------------------------------------------------------------------
+
+bool
+NachOSscheduler::AdmitDeadline (double utilization, int group)
+{
+    return policy->Reserve(utilization, group);
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::DeclareJob
+// 	Called by the batch loader once it has created "thread" for a job
+//	of fair-share group "group", with the relative deadline, period
+//	and worst-case execution ticks the job declared (deadline 0 if
+//	none).  The first instance of a deadline job is released now.
+//----------------------------------------------------------------------
 
-        delete minElementPtr;
-        return minThreadPtr;
+void
+NachOSscheduler::DeclareJob (NachOSThread *thread, int group, int deadline,
+                             int period, int wcet)
+{
+    if (deadline > 0)
+        thread->deadlineJob = new DeadlineJob(deadline, period, wcet);
+    policy->DeclareJob(thread, group);
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::ForkState
+// 	Return the scheduling state a child of "parent" starts with: what
+//	the policy's record of the parent passes on, NULL if nothing.
+//----------------------------------------------------------------------
+
+SchedState *
+NachOSscheduler::ForkState (NachOSThread *parent)
+{
+    return policy->ForkState(parent);
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::ThreadFinished
+// 	Called by an exiting thread, after EndBurst.  The policy hands
+//	its figures for the thread to the statistics, and then its record
+//	of the thread is freed.  A one-shot deadline job is checked against
+//	its deadline, and the figures of a deadline job of either kind go
+//	to the statistics.
+//----------------------------------------------------------------------
+
+void
+NachOSscheduler::ThreadFinished (NachOSThread *thread)
+{
+    DeadlineJob *job = thread->deadlineJob;
+
+    policy->ThreadExited(thread);
+    if (traceRecorder != NULL)
+        traceRecorder->Exited(thread);
+    delete thread->schedState;
+    thread->schedState = NULL;
+
+    if (job != NULL) {
+        if (job->period == 0)
+            EndInstance(thread);
+        stats->RecordDeadlineJob(thread->GetPID(), job->deadline,
+                job->period, job->instances, job->misses, job->maxLateness);
+        delete job;
+        thread->deadlineJob = NULL;
     }
 }
 
+//----------------------------------------------------------------------
+// NachOSscheduler::EndInstance
+// 	An instance of the deadline job "thread" has completed now.  Check
+//	it against its deadline, and release the next instance of a
+//	periodic job one period after this one.
+//----------------------------------------------------------------------
+
+void
+NachOSscheduler::EndInstance (NachOSThread *thread)
+{
+    DeadlineJob *job = thread->deadlineJob;
+    int lateness = stats->totalTicks - job->absDeadline;
+
+    job->instances++;
+    if (lateness > 0) {
+        job->misses++;
+        if (lateness > job->maxLateness)
+            job->maxLateness = lateness;
+        DEBUG('t', "Thread %d missed its deadline %d by %d ticks\n",
+                thread->GetPID(), job->absDeadline, lateness);
+    }
+    stats->RecordDeadline(lateness);
+
+    if (job->period > 0) {
+        job->release += job->period;
+        job->absDeadline = job->release + job->deadline;
+    }
+}
+
+DeadlineJob::DeadlineJob(int relDeadline, int jobPeriod, int jobWcet)
+{
+    deadline = relDeadline;
+    period = jobPeriod;
+    wcet = jobWcet;
+    release = stats->totalTicks;
+    absDeadline = release + deadline;
+    instances = misses = maxLateness = 0;
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::ShouldPreempt
+// 	Called from the scheduler's timer interrupt handler.  Decide
+//	whether the running thread has to give up the CPU.
+//
+//	The non-preemptive policies (1, 2) never preempt.  Round robin,
+//	UNIX (3-10) and gang scheduling preempt on every timer interrupt,
+//	since the timer is programmed with their quantum.  MLFQ programs
+//	the timer with the smallest quantum and preempts once the current
+//	burst has reached the quantum of the thread's level; CFS does the
+//	same with its dynamic time slice, and also preempts for a thread
+//	that woke up on a better level.  SRTF and EDF preempt only for a
+//	thread made ready since the last dispatch that should run first.
+//
+//	"thread" is the running thread.
+//----------------------------------------------------------------------
+
+bool
+NachOSscheduler::ShouldPreempt (NachOSThread *thread)
+{
+    return policy->Tick(thread);
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::PreemptPending
+// 	Return TRUE if a thread made ready since the last dispatch should
+//	preempt the running thread: under SRTF or EDF any new thread, under
+//	UNIX or MLFQ one that woke up (and, for SRTF and EDF, count the
+//	preemption).  The request is consumed: the caller must yield.
+//	Called from the timer handler, and from system calls that make
+//	a thread ready, like fork.
+//----------------------------------------------------------------------
+
+bool
+NachOSscheduler::PreemptPending ()
+{
+    return policy->PreemptPending();
+}
+
+//----------------------------------------------------------------------
+// NachOSscheduler::StartBurst
+// 	"thread", just taken off the ready queue, starts running now:
+//	account its wait and start its burst.  Return the ticks the policy
+//	wants until the next timer interrupt, 0 to leave the timer alone.
+//	Called by Schedule, and by trace replay, which switches no stacks.
+//----------------------------------------------------------------------
+
+int
+NachOSscheduler::StartBurst (NachOSThread *thread)
+{
+    thread->setStatus(RUNNING);
+    thread->wait_time_sum += stats->totalTicks - thread->curr_wait_start;
+    thread->curr_cpu_burst_start = stats->totalTicks;
+    thread->cpu_burst_count++;
+    return policy->Dispatched(thread);
+}
+
 //----------------------------------------------------------------------
 // NachOSscheduler::Schedule
 // 	Dispatch the CPU to nextThread.  Save the state of the old thread,
@@ -193,13 +407,14 @@ NachOSscheduler::Schedule (NachOSThread *nextThread)
 					    // had an undetected stack overflow
 
     currentThread = nextThread;		    // switch to the next thread
-    currentThread->setStatus(RUNNING); 
-    //stats->cpu_burst_count++;     // nextThread is now running
-    nextThread->wait_time_sum += stats->totalTicks-(nextThread->curr_wait_start);
-//    printf("wait_time_sum=%d\n",nextThread->wait_time_sum );
-
-    nextThread->curr_cpu_burst_start=stats->totalTicks;
-    currentThread->cpu_burst_count++;
+    int quantum = StartBurst(nextThread);
+
+    // A policy with a quantum per thread reprograms the timer for it;
+    // several CPUs share the timer, so each keeps the end of its slice
+    if (numCPUs > 1)
+        processors[currentCPU]->StartSlice(quantum);
+    else if (quantum > 0)
+        timer->Reprogram(quantum);
     //printf("cpu_start=%d count=%d\t", currentThread->curr_cpu_burst_start,currentThread->cpu_burst_count);
     
     DEBUG('t', "Switching from thread \"%s\" with pid %d to thread \"%s\" with pid %d\n",
@@ -266,5 +481,5 @@ void
 NachOSscheduler::Print()
 {
     printf("Ready list contents:\n");
-    readyThreadList->Mapcar((VoidFunctionPtr) ThreadPrint);
+    policy->Print();
 }
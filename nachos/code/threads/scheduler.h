@@ -8,11 +8,40 @@
 
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
-#define MAX_THREAD_COUNT 1000
 
 #include "copyright.h"
 #include "list.h"
 #include "thread.h"
+#include "policy.h"
+
+// Quantum calibration (-C).  The quanta are derived from A, the average
+// CPU burst between blocking calls of a program run under FCFS: Q1, Q2
+// and Q3 are A/4, A/2 and 3A/4, and Q4 is the smallest quantum with
+// which round robin reaches its highest utilization; none is below
+// MIN_QUANTUM.  They are saved in CALIBRATION_FILE as "<name> <ticks>"
+// lines, and a batch file can name one instead of giving a number.
+#define MIN_QUANTUM		20
+#define CALIBRATION_COPIES	4	// copies of the program run at once
+#define CALIBRATION_TOLERANCE	0.001	// utilization this close is as high
+#define CALIBRATION_FILE	"quanta"
+
+// The deadline a batch job declared (-F batch file), and how well it
+// has kept it.  Misses and lateness are recorded under every policy, so
+// that EDF can be compared with the others.
+
+class DeadlineJob {
+  public:
+    DeadlineJob(int relDeadline, int jobPeriod, int jobWcet);
+
+    int deadline;			// relative deadline
+    int period;				// 0 if the job is one-shot
+    int wcet;				// declared worst-case execution ticks
+    int release;			// release time of the current instance
+    int absDeadline;			// deadline of the current instance
+    int instances;			// instances whose deadline was checked
+    int misses;				// ... and of those, how many were late
+    int maxLateness;			// worst lateness of an instance
+};
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
@@ -27,19 +56,70 @@ class NachOSscheduler {
     NachOSThread* FindNextThreadToRun();		// Dequeue first thread on the ready 
 					// list, if any, and return thread.
     void Schedule(NachOSThread* nextThread);	// Cause nextThread to start running
+    int StartBurst(NachOSThread* thread);	// Bookkeeping of a dispatch;
+                                        // returns the policy's time slice
     void Print();			// Print contents of ready list
     
     void Tail();                        // Used by fork()
 
-    double alpha;   // SJF estimation
-    int schedulerCode = 1;
+    void SetPolicy(int code, bool byGroup);
+                                        // Switch to the policy of
+                                        // schedulerCode "code", fair
+                                        // sharing between job groups if
+                                        // "byGroup"; the ready queue must
+                                        // be empty
+    int TimerPeriod() { return policy->TimerPeriod(); }
+                                        // Ticks between timer interrupts
+                                        // the policy wants
+    void SetTimerPeriod(int period) { policy->SetTimerPeriod(period); }
+                                        // ... or the batch file does
+
+    void EndBurst(NachOSThread* thread, int burst);
+                                        // Called whenever "thread" stops
+                                        // running (yield, block or exit)
+    void ThreadFinished(NachOSThread* thread);
+                                        // Called when "thread" exits
+
+    bool ShouldPreempt(NachOSThread* thread);
+                                        // Called on every scheduler timer
+                                        // interrupt: has "thread" used up
+                                        // its quantum?
+    bool PreemptPending();              // Has a newly ready thread asked
+                                        // to preempt the running one?
+    bool AdmitDeadline(double utilization, int group);
+                                        // EDF admission control: reserve
+                                        // "utilization", if the CPU has it
+    void DeclareJob(NachOSThread* thread, int group, int deadline,
+                    int period, int wcet);
+                                        // "thread" runs a new batch job
+                                        // with this group and deadline
+    SchedState *ForkState(NachOSThread* parent);
+                                        // Scheduling state of a child
+                                        // "parent" is creating
 
-    int quantum;
-    int cpuCount[MAX_THREAD_COUNT];
+    int NumReady() { return numReady; } // Number of threads on the ready
+                                        // queue, whatever its structure
+    void Migrate(NachOSThread* thread, NachOSscheduler* from);
+                                        // "thread", just taken off "from"'s
+                                        // ready queue, will run here
+
+    double alpha;   // SJF estimation
+    bool adaptiveAlpha;                 // tune alpha per thread (-alpha adaptive)
+    double agingRate;                   // SJF/UNIX priority gained per tick
+                                        // on the ready queue (-aging)
+    char *dispatchTableFile;            // time-sharing dispatch table (-ts)
+    int schedulerCode;                  // set by SetPolicy; read only
+    bool groupScheduling;               // ditto
 
   private:
-    List *readyThreadList;  		// queue of threads that are ready to run,
-				// but not running
+    void PreemptOnWakeup();
+    void EndInstance(NachOSThread* thread);
+                                        // an instance of "thread"'s
+                                        // deadline job has completed now
+
+    int numReady;			// threads on the ready queue
+    SchedulingPolicy *policy;		// owns the ready queue, and decides
+					// which thread runs next
 };
 
 #endif // SCHEDULER_H
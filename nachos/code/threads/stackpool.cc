@@ -0,0 +1,72 @@
+// stackpool.cc
+//	Routines to recycle thread stacks.  See stackpool.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "stackpool.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// StackPool::StackPool
+//	An empty pool, that will keep up to "poolSize" stacks.  With 0,
+//	every stack goes straight back to the host.
+//----------------------------------------------------------------------
+
+StackPool::StackPool(int poolSize)
+{
+    ASSERT(poolSize >= 0);
+    maxStacks = poolSize;
+    freeStacks = NULL;
+    numFree = 0;
+}
+
+StackPool::~StackPool()
+{
+    int *stack;
+
+    while ((stack = freeStacks) != NULL) {
+	freeStacks = *(int **)stack;
+	DeallocBoundedArray((char *)stack, StackSize * sizeof(int));
+    }
+}
+
+//----------------------------------------------------------------------
+// StackPool::Get
+//	Return a stack with guard pages: the one freed last, or a new one.
+//----------------------------------------------------------------------
+
+int *
+StackPool::Get()
+{
+    int *stack = freeStacks;
+
+    if (stack == NULL) {
+	stats->stack_pool_misses++;
+	return (int *)AllocBoundedArray(StackSize * sizeof(int));
+    }
+    stats->stack_pool_hits++;
+    freeStacks = *(int **)stack;
+    numFree--;
+    return stack;
+}
+
+//----------------------------------------------------------------------
+// StackPool::Put
+//	Keep "stack", which came from Get, for the next thread, unless
+//	the pool is full.  The guard pages stay unmapped.
+//----------------------------------------------------------------------
+
+void
+StackPool::Put(int *stack)
+{
+    if (numFree == maxStacks) {
+	DeallocBoundedArray((char *)stack, StackSize * sizeof(int));
+	return;
+    }
+    *(int **)stack = freeStacks;
+    freeStacks = stack;
+    numFree++;
+}
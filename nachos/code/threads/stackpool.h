@@ -0,0 +1,39 @@
+// stackpool.h
+//	Data structures for a cache of thread execution stacks.
+//
+//	A stack comes from AllocBoundedArray, with the pages on either side
+//	of it unmapped to catch overflows; getting one costs the host two
+//	mprotect calls, and giving it back two more.  Threads that come and
+//	go quickly (Fork, Exit) pay that every time.  The pool keeps the
+//	stacks of destroyed threads, guard pages and all, and hands them to
+//	new threads, up to a limit set with -stacks.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef STACKPOOL_H
+#define STACKPOOL_H
+
+#include "copyright.h"
+
+#define STACK_POOL_SIZE		16	// stacks kept, unless -stacks says
+
+// The following class defines the pool.  The free stacks are linked
+// through their first word, which AllocateThreadStack overwrites.
+
+class StackPool {
+  public:
+    StackPool(int poolSize);		// keep up to "poolSize" free stacks
+    ~StackPool();			// give them all back to the host
+
+    int *Get();				// a stack of StackSize words
+    void Put(int *stack);		// a stack no thread uses any more
+
+  private:
+    int *freeStacks;			// the free stacks, NULL if none
+    int numFree;
+    int maxStacks;
+};
+
+#endif // STACKPOOL_H
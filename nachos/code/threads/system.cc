@@ -20,12 +20,17 @@ Timer *timer;				// the hardware timer device,
 					// for invoking context switches
 unsigned numPagesAllocated;              // number of physical frames allocated
 
-NachOSThread *threadArray[MAX_THREAD_COUNT];  // Array of thread pointers
-unsigned thread_index;                  // Index into this array (also used to assign unique pid)
+PidTable *pidTable;                     // Hands out pids, finds threads by pid
+StackPool *stackPool;                   // Recycles thread stacks (-stacks)
 bool initializedConsoleSemaphores;
-bool exitThreadArray[MAX_THREAD_COUNT];  //Marks exited threads
 
 TimeSortedWaitQueue *sleepQueueHead;    // Needed to implement SC_Sleep
+BurstHistory *burstHistory;             // Seeds SJF/SRTF predictions
+TraceRecorder *traceRecorder;           // Records bursts for replay (-trace)
+
+int numCPUs;                            // Number of simulated CPUs
+int currentCPU;                         // The CPU being simulated
+Processor *processors[MAX_CPUS];        // State of each CPU
 
 #ifdef FILESYS_NEEDED
 FileSystem  *fileSystem;
@@ -37,6 +42,7 @@ SynchDisk   *synchDisk;
 
 #ifdef USER_PROGRAM	// requires either FILESYS or FILESYS_STUB
 Machine *machine;	// user program memory and registers
+BitMap *physFrameMap;	// which physical frames are allocated
 #endif
 
 #ifdef NETWORK
@@ -77,7 +83,8 @@ TimerInterruptHandler(int dummy)
            delete ptr;
         }
         //printf("[%d] Timer interrupt.\n", stats->totalTicks);
-        interrupt->YieldOnReturn();
+        if (numCPUs == 1)       // CPUs are preempted by PreemptProcessors
+            interrupt->YieldOnReturn();
     }
 }
 
@@ -94,20 +101,26 @@ TimerInterruptHandler(int dummy)
 void
 Initialize(int argc, char **argv)
 {
-    int argCount, i;
+    int argCount;
     char* debugArgs = "";
     bool randomYield = FALSE;
+    char* alphaArg = NULL;
+    double agingRate = 0.0;
+    char* dispatchTableFile = NULL;
+    int maxStacks = STACK_POOL_SIZE;
 
     initializedConsoleSemaphores = false;
     numPagesAllocated = 0;
 
-    for (i=0; i<MAX_THREAD_COUNT; i++) { threadArray[i] = NULL; exitThreadArray[i] = false; }
-    thread_index = 0;
+    pidTable = new PidTable();
 
     sleepQueueHead = NULL;
+    burstHistory = NULL;
+    traceRecorder = NULL;
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    int ncpu = 1;		// number of simulated CPUs
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
@@ -132,10 +145,38 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-alpha")) {
+	    ASSERT(argc > 1);
+	    alphaArg = *(argv + 1);		// SJF/SRTF estimator alpha
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-aging")) {
+	    ASSERT(argc > 1);
+	    agingRate = atof(*(argv + 1));	// SJF/UNIX anti-starvation
+	    ASSERT(agingRate >= 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-ts")) {
+	    ASSERT(argc > 1);
+	    dispatchTableFile = *(argv + 1);	// time-sharing dispatch table
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-trace")) {
+	    ASSERT(argc > 1);
+	    traceRecorder = new TraceRecorder(*(argv + 1));
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-stacks")) {
+	    ASSERT(argc > 1);
+	    maxStacks = atoi(*(argv + 1));	// free thread stacks kept
+	    ASSERT(maxStacks >= 0);
+	    argCount = 2;
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+	else if (!strcmp(*argv, "-ncpu")) {
+	    ASSERT(argc > 1);
+	    ncpu = atoi(*(argv + 1));
+	    ASSERT(ncpu >= 1 && ncpu <= MAX_CPUS);
+	    argCount = 2;
+	}
 #endif
 #ifdef FILESYS_NEEDED
 	if (!strcmp(*argv, "-f"))
@@ -156,8 +197,21 @@ Initialize(int argc, char **argv)
 
     DebugInit(debugArgs);			// initialize DEBUG messages
     stats = new Statistics();			// collect statistics
+    stackPool = new StackPool(maxStacks);	// recycle thread stacks
     interrupt = new Interrupt;			// start up interrupt handling
     scheduler = new NachOSscheduler();		// initialize the ready queue
+    if (alphaArg != NULL) {
+	if (!strcmp(alphaArg, "adaptive"))
+	    scheduler->adaptiveAlpha = TRUE;
+	else
+	    scheduler->alpha = atof(alphaArg);
+    }
+    scheduler->agingRate = agingRate;
+    if (dispatchTableFile != NULL)
+	scheduler->dispatchTableFile = dispatchTableFile;
+    numCPUs = 1;
+    currentCPU = 0;
+    processors[0] = new Processor(0, scheduler);
     //if (randomYield)				// start the timer (if needed)
 	timer = new Timer(TimerInterruptHandler, 0, randomYield, 100);
 
@@ -176,6 +230,9 @@ Initialize(int argc, char **argv)
     
 #ifdef USER_PROGRAM
     machine = new Machine(debugUserProg);	// this must come first
+    physFrameMap = new BitMap(NumPhysPages);
+    if (ncpu > 1)
+	StartProcessors(ncpu);			// after main and machine exist
 #endif
 
 #ifdef FILESYS
@@ -204,6 +261,7 @@ Cleanup()
 #endif
     
 #ifdef USER_PROGRAM
+    delete physFrameMap;
     delete machine;
 #endif
 
@@ -215,6 +273,8 @@ Cleanup()
     delete synchDisk;
 #endif
     
+    delete traceRecorder;
+    delete stackPool;
     delete timer;
     delete scheduler;
     delete interrupt;
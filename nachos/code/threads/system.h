@@ -15,8 +15,11 @@
 #include "interrupt.h"
 #include "stats.h"
 #include "timer.h"
-
-#define MAX_THREAD_COUNT 1000
+#include "bursthistory.h"
+#include "processor.h"
+#include "trace.h"
+#include "pidtable.h"
+#include "stackpool.h"
 
 // Initialization and cleanup routines
 extern void Initialize(int argc, char **argv); 	// Initialization,
@@ -32,10 +35,9 @@ extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
 extern unsigned numPagesAllocated;              // number of physical frames allocated
 
-extern NachOSThread *threadArray[];  			// Array of thread pointers
-extern unsigned thread_index;                  // Index into this array (also used to assign unique pid)
+extern PidTable *pidTable;			// pids, and the thread of each
+extern StackPool *stackPool;			// free thread stacks
 extern bool initializedConsoleSemaphores;       // Used to initialize the semaphores for console I/O exactly once
-extern bool exitThreadArray[];          // Marks exited threads
 
 class TimeSortedWaitQueue {             // Needed to implement SYScall_Sleep
 private:
@@ -55,9 +57,20 @@ public:
 
 extern TimeSortedWaitQueue *sleepQueueHead;
 
+extern int numCPUs;                     // Number of simulated CPUs (-ncpu)
+extern int currentCPU;                  // The CPU being simulated
+extern Processor *processors[];         // State of each CPU
+
+extern BurstHistory *burstHistory;     // Per-executable burst estimates, NULL
+                                        // unless running a batch file
+extern TraceRecorder *traceRecorder;   // Writes the CPU bursts of jobs,
+                                        // NULL unless -trace
+
 #ifdef USER_PROGRAM
 #include "machine.h"
+#include "bitmap.h"
 extern Machine* machine;	// user program memory and registers
+extern BitMap *physFrameMap;	// which physical frames are allocated
 #endif
 
 #ifdef FILESYS_NEEDED 		// FILESYS or FILESYS_STUB 
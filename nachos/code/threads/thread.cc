@@ -33,49 +33,38 @@ NachOSThread::numThreads = 0;
 //	NachOSThread::ThreadFork.
 //
 //	"threadName" is an arbitrary string, useful for debugging.
+//
+//	A thread forked by the running thread starts with the scheduling
+//	state its parent passes on (the policy decides what: tickets,
+//	deadline, group, ...).
 //----------------------------------------------------------------------
 
 NachOSThread::NachOSThread(char* threadName)
 {
-    int i;
-
-    name = threadName;
-    stackTop = NULL;
-    stack = NULL;
-    status = JUST_CREATED;
-#ifdef USER_PROGRAM
-    space = NULL;
-    stateRestored = true;
-#endif
-
-    threadArray[thread_index] = this;
-    pid = thread_index;
-    thread_index++;
-    ASSERT(thread_index < MAX_THREAD_COUNT);
-    if (currentThread != NULL) {
-       ppid = currentThread->GetPID();
-       currentThread->RegisterNewChild (pid);
-    }
-    else ppid = -1;
-
-    childcount = 0;
-    waitchild_id = -1;
-
-    for (i=0; i<MAX_CHILD_COUNT; i++) exitedChild[i] = false;
-
-    priority = 50;
-    numThreads++;
-    wait_time_sum = 0;
-    curr_wait_start = stats->totalTicks;
-    instructionCount = 0;
+    Initialize(threadName, 0);
+    if (currentThread != NULL)
+        schedState = scheduler->ForkState(currentThread);
 }
 
-// New constructor with priority of the thread
+// New constructor with priority of the thread: a batch job, which
+// inherits nothing, and is scheduled by its priority
 
 NachOSThread::NachOSThread(char* threadName, int newPriority)
 {
-    int i;
+    Initialize(threadName, newPriority);
+}
+
+//----------------------------------------------------------------------
+// NachOSThread::Initialize
+// 	The part of the constructors common to both: give the thread a
+//	pid, make it its creator's child, and start its accounting.
+//
+//	"newPriority" is its batch priority.
+//----------------------------------------------------------------------
 
+void
+NachOSThread::Initialize(char* threadName, int newPriority)
+{
     name = threadName;
     stackTop = NULL;
     stack = NULL;
@@ -85,22 +74,22 @@ NachOSThread::NachOSThread(char* threadName, int newPriority)
     stateRestored = true;
 #endif
 
-    threadArray[thread_index] = this;
-    pid = thread_index;
-    thread_index++;
-    ASSERT(thread_index < MAX_THREAD_COUNT);
+    pid = pidTable->Add(this);
     if (currentThread != NULL) {
        ppid = currentThread->GetPID();
        currentThread->RegisterNewChild (pid);
     }
     else ppid = -1;
 
-    childcount = 0;
     waitchild_id = -1;
 
-    for (i=0; i<MAX_CHILD_COUNT; i++) exitedChild[i] = false;
-
-    priority = 50 + newPriority;
+    batchPriority = newPriority;
+    schedState = NULL;
+    deadlineJob = NULL;
+    execName = NULL;
+    blockCount = 0;
+    traceBurst = 0;
+    woken = false;
     numThreads++;
     wait_time_sum = 0;
     curr_wait_start = stats->totalTicks;
@@ -125,7 +114,14 @@ NachOSThread::~NachOSThread()
 
   ASSERT(this != currentThread);
   if (stack != NULL)
-    DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+    stackPool->Put(stack);
+  if (pidTable->Lookup(pid) == this)    // never exited: no one will Join
+    pidTable->Free(pid);
+  delete schedState;                    // if it never exited either
+  delete deadlineJob;
+#ifdef USER_PROGRAM
+  delete space;                         // give its frames back
+#endif
   numThreads--;
 }
 
@@ -226,18 +222,13 @@ NachOSThread::FinishThread ()
 void
 NachOSThread::SetChildExitCode (int childpid, int ecode)
 {
-   unsigned i;
-
-   // Find out which child
-   for (i=0; i<childcount; i++) {
-      if (childpid == childpidArray[i]) break;
-   }
+   ChildRecord *child = children.Lookup(childpid);
 
-   ASSERT(i < childcount);
-   childexitcode[i] = ecode;
-   exitedChild[i] = true;
+   ASSERT(child != NULL);
+   child->exitCode = ecode;
+   child->exited = true;
 
-   if (waitchild_id == (int)i) {
+   if (waitchild_id == childpid) {
       waitchild_id = -1;
       // I will wake myself up
       IntStatus oldLevel = interrupt->SetLevel(IntOff);
@@ -274,6 +265,7 @@ NachOSThread::Exit (bool terminateSim, int exitcode)
         stats->thread_count++;
 
         stats->wait_time_total+=currentThread->wait_time_sum;
+        stats->RecordThreadWait(currentThread->wait_time_sum);
           currentThread->cpu_burst_sum+=burst_time;
           stats->cpu_burst_total+=burst_time;
           stats->cpu_burst_count++;
@@ -290,29 +282,19 @@ NachOSThread::Exit (bool terminateSim, int exitcode)
       }
     }
 
-    if (currentThread->prev_cpu_burst > 0) {
-      if (scheduler->schedulerCode >= 7 && scheduler->schedulerCode <= 10) {
-        int i;
-        int pid = currentThread->GetPID();
-
-        scheduler->cpuCount[pid] += currentThread->prev_cpu_burst;
-
-        for (i=0; i < MAX_THREAD_COUNT; i++) {
-          scheduler->cpuCount[i] = scheduler->cpuCount[i] / 2;
-          if (threadArray[i] != NULL)
-            threadArray[i]->priority += scheduler->cpuCount[i] / 2;
-        }
-      }
-    }
+    scheduler->EndBurst(currentThread, burst_time);
+    scheduler->ThreadFinished(currentThread);
 
     //printf("pidfromExit=%d cpu_burst_sum=%d cpu_burst_count=%d\n stats count=%d stats sum=%d",pid,cpu_burst_sum,cpu_burst_count,stats->cpu_burst_count,stats->cpu_burst_total);
-    // Set exit code in parent's structure provided the parent hasn't exited
-    if (ppid != -1) {
-       ASSERT(threadArray[ppid] != NULL);
-       if (!exitThreadArray[ppid]) {
-          threadArray[ppid]->SetChildExitCode (pid, exitcode);
-       }
-    }
+    // Set exit code in parent's structure provided the parent hasn't exited;
+    // it keeps our pid until it exits too.  If it has, its pid may now
+    // belong to someone else, and no one can Join with us.
+    NachOSThread *parent = pidTable->Lookup(ppid);
+    if (parent != NULL && parent->CheckIfChild(pid) >= 0)
+       parent->SetChildExitCode (pid, exitcode);
+    else
+       pidTable->Free(pid);
+    FreeExitedChildren();
 
     if (numThreads == 1) {
       terminateSim=true;
@@ -326,6 +308,8 @@ NachOSThread::Exit (bool terminateSim, int exitcode)
            printf("Assuming all programs completed.\n");
            interrupt->Halt();
         }
+        else if ((nextThread = IdleThread()) != NULL)
+           break;                    // multiprocessor: let this CPU idle
         else interrupt->Idle();      // no one to run, wait for an interrupt
     }
     scheduler->Schedule(nextThread); // returns when we've been signalled
@@ -380,20 +364,7 @@ NachOSThread::YieldCPU ()
       }
     }
 
-    if (currentThread->prev_cpu_burst > 0) {
-      if (scheduler->schedulerCode >= 7 && scheduler->schedulerCode <= 10) {
-        int i;
-        int pid = currentThread->GetPID();
-
-        scheduler->cpuCount[pid] += currentThread->prev_cpu_burst;
-
-        for (i=0; i < MAX_THREAD_COUNT; i++) {
-          scheduler->cpuCount[i] = scheduler->cpuCount[i] / 2;
-          if (threadArray[i] != NULL)
-            threadArray[i]->priority += scheduler->cpuCount[i] / 2;
-        }
-      }
-    }
+    scheduler->EndBurst(currentThread, burst_time);
     
     if (yieldAt)
     {
@@ -468,8 +439,13 @@ NachOSThread::PutThreadToSleep ()
        // printf("cpuburstsumfrom sleep=%d\n",currentThread->cpu_burst_sum);
     }
   }
-    while ((nextThread = scheduler->FindNextThreadToRun()) == NULL)
+    scheduler->EndBurst(currentThread, burst_time);
+    currentThread->blockCount++;
+    while ((nextThread = scheduler->FindNextThreadToRun()) == NULL) {
+        if ((nextThread = IdleThread()) != NULL)
+            break;              // multiprocessor: let this CPU idle
 	interrupt->Idle();	// no one to run, wait for an interrupt
+    }
         
     scheduler->Schedule(nextThread); // returns when we've been signalled
 }
@@ -501,7 +477,7 @@ void ThreadPrint(int arg){ NachOSThread *t = (NachOSThread *)arg; t->Print(); }
 void
 NachOSThread::AllocateThreadStack (VoidFunctionPtr func, int arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = stackPool->Get();
 
 #ifdef HOST_SNAKE
     // HP stack works from low addresses to high addresses
@@ -575,43 +551,67 @@ NachOSThread::RestoreUserState()
 //----------------------------------------------------------------------
 // NachOSThread::CheckIfChild
 //      Checks if the passed pid belongs to a child of mine.
-//      Returns child id if all is fine; otherwise returns -1.
+//      Returns the pid if all is fine; otherwise returns -1.
 //----------------------------------------------------------------------
 
 int
 NachOSThread::CheckIfChild (int childpid)
 {
-   unsigned i;
+   if (children.Lookup(childpid) == NULL) return -1;
+   return childpid;
+}
 
-   // Find out which child
-   for (i=0; i<childcount; i++) {
-      if (childpid == childpidArray[i]) break;
-   }
+//----------------------------------------------------------------------
+// NachOSThread::FreeExitedChildren
+//      Called by an exiting thread.  The pids of its children that have
+//      exited but were never joined were kept in case it joined them;
+//      now they can be reused.  Joined children were forgotten, and
+//      their pids freed, by JoinWithChild; live children free their
+//      own pids when they exit.
+//----------------------------------------------------------------------
 
-   if (i == childcount) return -1;
-   return i;
+void
+NachOSThread::FreeExitedChildren ()
+{
+   ChildRecord *child;
+
+   for (child = children.Next(NULL); child != NULL; child = children.Next(child)) {
+      if (child->exited) pidTable->Free(child->pid);
+   }
 }
 
 //----------------------------------------------------------------------
 // NachOSThread::JoinWithChild
 //      Called by a thread as a result of SYScall_Join.
-//      Returns the exit code of the child being joined with.
+//      Returns the exit code of the child being joined with.  The
+//      child is reaped: it is no longer ours, and its pid can be reused.
 //----------------------------------------------------------------------
 
 int
-NachOSThread::JoinWithChild (int whichchild)
+NachOSThread::JoinWithChild (int childpid)
 {
+   ChildRecord *child = children.Lookup(childpid);
+   int exitcode;
+
+   ASSERT(child != NULL);
    // Has the child exited?
-   if (!exitedChild[whichchild]) {
+   if (!child->exited) {
       // Put myself to sleep
-      waitchild_id = whichchild;
+      waitchild_id = childpid;
       IntStatus oldLevel = interrupt->SetLevel(IntOff);
+      int joinStart = stats->totalTicks;
       printf("[pid %d] Before sleep in JoinWithChild.\n", pid);
       PutThreadToSleep();
       printf("[pid %d] After sleep in JoinWithChild.\n", pid);
+      stats->RecordJoinWait(stats->totalTicks - joinStart);
       (void) interrupt->SetLevel(oldLevel);
    }
-   return childexitcode[whichchild];
+   else
+      stats->RecordJoinWait(0);
+   exitcode = child->exitCode;
+   children.Remove(childpid);
+   pidTable->Free(childpid);
+   return exitcode;
 }
 
 #ifdef USER_PROGRAM
@@ -37,10 +37,12 @@
 #ifndef THREAD_H
 #define THREAD_H
 
-#define MAX_CHILD_COUNT 100
-
 #include "copyright.h"
 #include "utility.h"
+#include "childtable.h"
+
+class SchedState;
+class DeadlineJob;
 
 #ifdef USER_PROGRAM
 #include "machine.h"
@@ -102,7 +104,6 @@ class NachOSThread {
     int curr_block_start=0;
     int block_time=0;
     int prev_cpu_burst=0;
-    double prev_expected_cpu_burst=0.0;
     
 
 
@@ -122,6 +123,7 @@ class NachOSThread {
     void CheckOverflow();   			// Check if thread has 
 						// overflowed its stack
     void setStatus(ThreadStatus st) { status = st; }
+    ThreadStatus getStatus() { return status; }
     char* getName() { return (name); }
     void Print() { printf("%s, ", name); }
 
@@ -133,9 +135,12 @@ class NachOSThread {
     int CheckIfChild (int childpid);                    // Called by Join to verify that the caller
                                                         // is joining a legitimate child.
 
-    int JoinWithChild (int whichchild);                 // Called by SYScall_Join
+    int JoinWithChild (int childpid);                   // Called by SYScall_Join
 
-    void RegisterNewChild (int childpid) { childpidArray[childcount] = childpid; childcount++; ASSERT(childcount < MAX_CHILD_COUNT); }
+    void FreeExitedChildren ();                         // Called by Exit to let the pids of
+                                                        // exited children be reused
+
+    void RegisterNewChild (int childpid) { children.Add(childpid); }
 
     void Schedule ();                                   // Called by SYScall_Fork to enqueue the newly created child thread in the ready queue
 
@@ -150,10 +155,25 @@ class NachOSThread {
     unsigned GetInstructionCount();
 
     static int numThreads;
-    int priority;
+    int batchPriority;                  // 0..100 from the batch file, lower
+                                        // is better; 0 if not a batch job
+
+    SchedState *schedState;             // The policy's record of us, NULL
+                                        // until a policy has seen us
+    DeadlineJob *deadlineJob;           // Deadline of our batch job, NULL
+                                        // if it declared none
+
+    char *execName;                     // Executable of a batch job, else NULL
+    int blockCount;                     // Times the thread has gone to sleep
+    int traceBurst;                     // CPU ticks since it last blocked, for -trace
+
+    bool woken;                         // Made ready from BLOCKED, not yet run
 
   private:
     // some of the private data for this class is listed above
+
+    void Initialize(char* threadName, int newPriority);
+                                        // Common part of the constructors
     
     int* stack; 	 		// Bottom of the stack 
 					// NULL if this is the main thread
@@ -163,12 +183,10 @@ class NachOSThread {
 
     int pid, ppid;			// My pid and my parent's pid
 
-    int childpidArray[MAX_CHILD_COUNT]; // My children
-    int childexitcode[MAX_CHILD_COUNT]; // Exit code of my children (return values for Join calls)
-    bool exitedChild[MAX_CHILD_COUNT];  // Which children have exited?
-    unsigned childcount;                // Count of children
+    ChildTable children;                // My children, and the exit codes of those
+                                        // that have exited (return values for Join calls)
 
-    int waitchild_id;                   // Child I am waiting on (as a result of a Join call)
+    int waitchild_id;                   // Pid of the child I am waiting on (as a result of a Join call)
 
     unsigned instructionCount;		// Keeps track of the instruction count executed by this thread
 
@@ -49,3 +49,1238 @@ ThreadTest()
     SimpleThread(0);
 }
 
+
+//----------------------------------------------------------------------
+// LinearScanRemoveMin
+// 	The ready-queue pick used by the UNIX scheduler before the
+//	PriorityRunQueue: scan the whole list for the smallest priority,
+//	then unlink it.  Kept here only so ReadyQueueBenchmark has
+//	something to compare against.  The threads kept their priority
+//	then; a ScanEntry stands in for that.
+//----------------------------------------------------------------------
+
+class ScanEntry {
+  public:
+    NachOSThread *thread;
+    int priority;
+};
+
+static ScanEntry *
+LinearScanRemoveMin(List *list)
+{
+    ListElement *ptr, *prev, *minPtr, *minPrev;
+    ScanEntry *entry;
+
+    if (list->IsEmpty())
+	return NULL;
+
+    minPtr = list->first;
+    minPrev = NULL;
+    for (prev = list->first, ptr = prev->next; ptr != NULL;
+					prev = ptr, ptr = ptr->next) {
+	if (((ScanEntry *)ptr->item)->priority <
+			((ScanEntry *)minPtr->item)->priority) {
+	    minPtr = ptr;
+	    minPrev = prev;
+	}
+    }
+    if (minPrev == NULL)
+	return (ScanEntry *)list->Remove();
+    minPrev->next = minPtr->next;
+    if (minPtr == list->last)
+	list->last = minPrev;
+    entry = (ScanEntry *)minPtr->item;
+    delete minPtr;
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// ReadyQueueBenchmark
+// 	Measure the host time of one UNIX-scheduler context switch worth
+//	of ready-queue work -- pick the best thread, then put it back with
+//	a new priority -- with 10, 100 and 1000 threads ready.  The old
+//	path is a List with a linear scan; the new path is the scheduler
+//	itself running with schedulerCode 7 (PriorityRunQueue), charging
+//	each thread a burst as a switch would, which also decays the CPU
+//	usage of the other ready threads.
+//
+//	The threads never run; they only exist to be queued.
+//----------------------------------------------------------------------
+
+#define BENCH_ROUNDS	100000
+
+void
+ReadyQueueBenchmark()
+{
+    static int depths[] = { 10, 100, 1000 };
+    int maxDepth = 1000;
+    int savedCode = scheduler->schedulerCode;
+    bool savedByGroup = scheduler->groupScheduling;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    NachOSThread **threads;
+    NachOSThread *t;
+    ScanEntry *entries, *e;
+    List *list;
+    double start, oldNs, newNs;
+    int d, i, n, round;
+
+    // The queued threads are nobody's children; hide currentThread while
+    // creating them so they do not use up our child slots.
+    t = currentThread;
+    currentThread = NULL;
+    threads = new NachOSThread*[maxDepth];
+    entries = new ScanEntry[maxDepth];
+    for (i = 0; i < maxDepth; i++) {
+	threads[i] = new NachOSThread("bench", Random() % 101);
+	entries[i].thread = threads[i];
+	entries[i].priority = UNIX_BASE_PRIORITY + threads[i]->batchPriority;
+    }
+    currentThread = t;
+
+    printf("ready threads, linear scan (ns/switch), priority queue (ns/switch)\n");
+    for (d = 0; d < 3; d++) {
+	n = depths[d];
+
+	list = new List;
+	for (i = 0; i < n; i++)
+	    list->Append((void *)&entries[i]);
+	start = HostTime();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+	    e = LinearScanRemoveMin(list);
+	    e->priority = UNIX_BASE_PRIORITY + e->thread->batchPriority
+				+ (Random() % 100) / 2;
+	    list->Append((void *)e);
+	}
+	oldNs = (HostTime() - start) * 1e9 / BENCH_ROUNDS;
+	delete list;
+
+	scheduler->SetPolicy(7, FALSE);
+	for (i = 0; i < n; i++)
+	    scheduler->ThreadIsReadyToRun(threads[i]);
+	start = HostTime();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+	    t = scheduler->FindNextThreadToRun();
+	    t->setStatus(RUNNING);
+	    scheduler->EndBurst(t, Random() % 100);
+	    scheduler->ThreadIsReadyToRun(t);
+	}
+	newNs = (HostTime() - start) * 1e9 / BENCH_ROUNDS;
+	while (scheduler->FindNextThreadToRun() != NULL)
+	    ;
+	scheduler->SetPolicy(savedCode, savedByGroup);
+
+	printf("%d, %.1f, %.1f\n", n, oldNs, newNs);
+    }
+
+    for (i = 0; i < maxDepth; i++)
+	delete threads[i];
+    delete [] threads;
+    delete [] entries;
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// SchedulerSwitchBenchmark
+// 	Measure the host time of the scheduler's share of one context
+//	switch under every policy: pick the next thread, end its burst,
+//	and put it back on the ready queue, as YieldCPU does.  Ten threads
+//	take turns, each running a burst of 1 to 100 ticks.
+//----------------------------------------------------------------------
+
+#define SWITCH_THREADS	10
+#define SWITCH_POLICIES	19
+
+void
+SchedulerSwitchBenchmark()
+{
+    int savedCode = scheduler->schedulerCode;
+    bool savedByGroup = scheduler->groupScheduling;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    NachOSThread *threads[SWITCH_THREADS];
+    NachOSThread *t;
+    double start;
+    int code, i, n, burst, round;
+
+    n = SWITCH_THREADS;
+    t = currentThread;
+    currentThread = NULL;
+    for (i = 0; i < n; i++)
+	threads[i] = new NachOSThread("bench", Random() % 101);
+    currentThread = t;
+
+    printf("schedulerCode, scheduler work (ns/switch)\n");
+    for (code = 1; code <= SWITCH_POLICIES; code++) {
+	scheduler->SetPolicy(code, FALSE);
+	for (i = 0; i < n; i++)
+	    scheduler->ThreadIsReadyToRun(threads[i]);
+	start = HostTime();
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+	    t = scheduler->FindNextThreadToRun();
+	    t->setStatus(RUNNING);
+	    burst = 1 + Random() % 100;
+	    t->curr_cpu_burst_start = stats->totalTicks - burst;
+	    scheduler->EndBurst(t, burst);
+	    scheduler->ThreadIsReadyToRun(t);
+	}
+	printf("%d, %.1f\n", code, (HostTime() - start) * 1e9 / BENCH_ROUNDS);
+	while (scheduler->FindNextThreadToRun() != NULL)
+	    ;
+    }
+    scheduler->SetPolicy(savedCode, savedByGroup);
+
+    for (i = 0; i < n; i++)
+	delete threads[i];
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Self-tests
+//	The checks run by SelfTest.  As in the benchmarks, the threads are
+//	only ever queued, never run: the tests play the part of the CPU,
+//	dispatching a thread, letting simulated time pass, and ending its
+//	burst the way YieldCPU and PutThreadToSleep would.  Every check
+//	is an ASSERT, so a failure stops Nachos where it happened.
+//----------------------------------------------------------------------
+
+// Take the next thread off the ready queue and start its burst
+
+static NachOSThread *
+Dispatch()
+{
+    NachOSThread *thread = scheduler->FindNextThreadToRun();
+
+    ASSERT(thread != NULL);
+    thread->setStatus(RUNNING);
+    thread->curr_cpu_burst_start = stats->totalTicks;
+    return thread;
+}
+
+// Let "thread" run on for "ticks"; would the timer preempt it then?
+
+static bool
+RunFor(NachOSThread *thread, int ticks)
+{
+    stats->totalTicks += ticks;
+    return scheduler->ShouldPreempt(thread);
+}
+
+// End the burst of "thread", preempted by the timer
+
+static void
+Preempt(NachOSThread *thread)
+{
+    thread->yieldAt = true;
+    scheduler->EndBurst(thread, stats->totalTicks - thread->curr_cpu_burst_start);
+    scheduler->ThreadIsReadyToRun(thread);
+    thread->yieldAt = false;
+}
+
+// End the burst of "thread", which goes to sleep; Wake makes it ready
+
+static void
+Block(NachOSThread *thread)
+{
+    thread->setStatus(BLOCKED);
+    scheduler->EndBurst(thread, stats->totalTicks - thread->curr_cpu_burst_start);
+}
+
+static void
+Wake(NachOSThread *thread)
+{
+    ASSERT(thread->getStatus() == BLOCKED);
+    scheduler->ThreadIsReadyToRun(thread);
+}
+
+//----------------------------------------------------------------------
+// UnixDecayTest
+// 	UNIX priority scheduling (schedulerCode 7): the lazy decay by epoch
+//	gives, after every burst, the CPU usage and priority of the eager
+//	loop it replaced -- add the burst to the thread that ran, halve
+//	every thread's usage, and recompute each priority as base + usage/2
+//	-- and the thread picked is always one of the best priority.
+//----------------------------------------------------------------------
+
+#define UNIX_TEST_THREADS	8
+#define UNIX_TEST_ROUNDS	2000
+
+static void
+UnixDecayTest()
+{
+    NachOSThread *threads[UNIX_TEST_THREADS];
+    int base[UNIX_TEST_THREADS], cpu[UNIX_TEST_THREADS];
+    int priority[UNIX_TEST_THREADS];
+    NachOSThread *t;
+    UnixState *state;
+    int i, round, burst, best;
+
+    scheduler->SetPolicy(7, FALSE);
+    for (i = 0; i < UNIX_TEST_THREADS; i++) {
+	threads[i] = new NachOSThread("test", Random() % 101);
+	base[i] = UNIX_BASE_PRIORITY + threads[i]->batchPriority;
+	cpu[i] = 0;
+	priority[i] = base[i];
+	scheduler->ThreadIsReadyToRun(threads[i]);
+    }
+
+    for (round = 0; round < UNIX_TEST_ROUNDS; round++) {
+	best = priority[0];
+	for (i = 1; i < UNIX_TEST_THREADS; i++)
+	    if (priority[i] < best)
+		best = priority[i];
+	t = Dispatch();
+	for (i = 0; threads[i] != t; i++)
+	    ;
+	ASSERT(priority[i] == best);
+
+	// Bursts up to twice the quantum, so usage builds up and decays
+	burst = 1 + Random() % 80;
+	stats->totalTicks += burst;
+	Preempt(t);
+	cpu[i] += burst;
+	for (i = 0; i < UNIX_TEST_THREADS; i++) {
+	    cpu[i] /= 2;
+	    priority[i] = base[i] + cpu[i] / 2;
+	    state = (UnixState *)threads[i]->schedState;
+	    ASSERT(state->cpuCount == cpu[i] && state->priority == priority[i]);
+	}
+    }
+
+    while (scheduler->FindNextThreadToRun() != NULL)
+	;
+    for (i = 0; i < UNIX_TEST_THREADS; i++)
+	delete threads[i];
+    printf("UNIX lazy decay: ok\n");
+}
+
+//----------------------------------------------------------------------
+// MLFQTest
+// 	The multilevel feedback queue (schedulerCode 11): a thread that
+//	uses up its quantum goes one level down, where the quantum is twice
+//	as long, until the bottom level; one that blocks comes one level
+//	up; a higher level always runs first; and the boost puts every
+//	thread back on level 0.
+//----------------------------------------------------------------------
+
+static void
+MLFQTest()
+{
+    NachOSThread *a = new NachOSThread("test", 0);
+    NachOSThread *b = new NachOSThread("test", 0);
+    int level, quantum;
+
+    // Start on a boost period of our own, so none comes mid-test
+    stats->totalTicks = (stats->totalTicks / MLFQ_BOOST_PERIOD + 1)
+					* MLFQ_BOOST_PERIOD;
+    scheduler->SetPolicy(11, FALSE);
+    scheduler->ThreadIsReadyToRun(a);
+    scheduler->ThreadIsReadyToRun(b);
+
+    // a uses up its level 0 quantum, and falls behind b
+    ASSERT(Dispatch() == a);
+    ASSERT(!RunFor(a, MLFQ_BASE_QUANTUM - 1));
+    ASSERT(RunFor(a, 1));
+    Preempt(a);
+    ASSERT(Dispatch() == b);
+    ASSERT(!RunFor(b, 5));
+    Block(b);
+
+    // a sinks one level per quantum to the bottom, and stays there
+    for (level = 1; level <= MLFQ_LEVELS; level++) {
+	if (level < MLFQ_LEVELS)
+	    quantum = MLFQ_BASE_QUANTUM << level;
+	else
+	    quantum = MLFQ_BASE_QUANTUM << (MLFQ_LEVELS - 1);
+	ASSERT(Dispatch() == a);
+	ASSERT(!RunFor(a, quantum - 1));
+	ASSERT(RunFor(a, 1));
+	Preempt(a);
+    }
+
+    // b, woken on level 0, goes ahead of a
+    Wake(b);
+    ASSERT(Dispatch() == b);
+    Block(b);
+
+    // a blocks, and comes back one level up with that level's quantum
+    ASSERT(Dispatch() == a);
+    ASSERT(!RunFor(a, 1));
+    Block(a);
+    Wake(a);
+    quantum = MLFQ_BASE_QUANTUM << (MLFQ_LEVELS - 2);
+    ASSERT(Dispatch() == a);
+    ASSERT(!RunFor(a, quantum - 1));
+    ASSERT(RunFor(a, 1));
+    Preempt(a);
+
+    // The next boost brings a back to level 0
+    stats->totalTicks = (stats->totalTicks / MLFQ_BOOST_PERIOD + 1)
+					* MLFQ_BOOST_PERIOD;
+    ASSERT(Dispatch() == a);
+    ASSERT(!RunFor(a, MLFQ_BASE_QUANTUM - 1));
+    ASSERT(RunFor(a, 1));
+    Block(a);
+
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+    delete a;
+    delete b;
+    printf("MLFQ demotion, promotion and boost: ok\n");
+}
+
+//----------------------------------------------------------------------
+// StrideTest
+// 	Stride scheduling (schedulerCode 12): CPU-bound threads holding
+//	100, 50 and 25 tickets get the CPU in that proportion, to within
+//	a couple of quanta at every point, so their shares converge on the
+//	target.  A thread that was blocked for a while gets no credit for
+//	the time it was away.
+//----------------------------------------------------------------------
+
+#define STRIDE_TEST_THREADS	3
+#define STRIDE_TEST_ROUNDS	700
+
+static void
+StrideTest()
+{
+    static int priorities[STRIDE_TEST_THREADS] = { 1, 51, 76 };
+    NachOSThread *threads[STRIDE_TEST_THREADS];
+    int tickets[STRIDE_TEST_THREADS], cpu[STRIDE_TEST_THREADS];
+    int allTickets = 0, allCPU = 0;
+    NachOSThread *t, *late;
+    int i, round, runs;
+
+    scheduler->SetPolicy(12, FALSE);
+    for (i = 0; i < STRIDE_TEST_THREADS; i++) {
+	threads[i] = new NachOSThread("test", priorities[i]);
+	tickets[i] = STRIDE_MAX_TICKETS - priorities[i];
+	allTickets += tickets[i];
+	cpu[i] = 0;
+	scheduler->ThreadIsReadyToRun(threads[i]);
+    }
+
+    // Every thread stays within two quanta of its share of the CPU
+    for (round = 0; round < STRIDE_TEST_ROUNDS; round++) {
+	t = Dispatch();
+	(void) RunFor(t, STRIDE_QUANTUM);
+	Preempt(t);
+	for (i = 0; threads[i] != t; i++)
+	    ;
+	cpu[i] += STRIDE_QUANTUM;
+	allCPU += STRIDE_QUANTUM;
+	for (i = 0; i < STRIDE_TEST_THREADS; i++)
+	    ASSERT(abs(cpu[i] * allTickets - allCPU * tickets[i])
+				<= 2 * STRIDE_QUANTUM * allTickets);
+    }
+
+    // The thread with the fewest tickets sleeps while the others run
+    late = threads[STRIDE_TEST_THREADS - 1];
+    while ((t = Dispatch()) != late) {
+	(void) RunFor(t, STRIDE_QUANTUM);
+	Preempt(t);
+    }
+    (void) RunFor(late, 1);
+    Block(late);
+    for (round = 0; round < STRIDE_TEST_ROUNDS; round++) {
+	t = Dispatch();
+	ASSERT(t != late);
+	(void) RunFor(t, STRIDE_QUANTUM);
+	Preempt(t);
+    }
+
+    // ... and, woken, gets its share from then on, not a burst of catch-up
+    Wake(late);
+    runs = 0;
+    for (round = 0; round < allTickets / tickets[STRIDE_TEST_THREADS - 1];
+								round++) {
+	t = Dispatch();
+	if (t == late)
+	    runs++;
+	(void) RunFor(t, STRIDE_QUANTUM);
+	Preempt(t);
+    }
+    ASSERT(runs >= 1 && runs <= 2);
+
+    while (scheduler->FindNextThreadToRun() != NULL)
+	;
+    for (i = 0; i < STRIDE_TEST_THREADS; i++)
+	delete threads[i];
+    printf("Stride shares: ok\n");
+}
+
+//----------------------------------------------------------------------
+// RBTreeTest
+// 	The red-black tree that orders CFS's ready queue: items come out
+//	smallest key first, equal keys in the order they went in, with
+//	removals interleaved with insertions, and Min agrees with RemoveMin.
+//----------------------------------------------------------------------
+
+#define TREE_TEST_ITEMS		1000
+#define TREE_TEST_KEYS		50	// few keys, so there are many ties
+
+static void
+RBTreeTest()
+{
+    RBTree *tree = new RBTree;
+    int items[TREE_TEST_ITEMS];
+    int *item, *min;
+    double key, minKey, lastKey;
+    int i, next = 0, lastItem;
+
+    ASSERT(tree->IsEmpty() && tree->RemoveMin(NULL) == NULL);
+
+    // Fill it, take half out, put the rest in, and empty it
+    for (int phase = 0; phase < 2; phase++) {
+	for (; next < (phase + 1) * TREE_TEST_ITEMS / 2; next++) {
+	    items[next] = next;
+	    tree->Insert((void *)&items[next], Random() % TREE_TEST_KEYS);
+	}
+	lastKey = -1;
+	lastItem = -1;
+	for (i = tree->NumInTree() / (2 - phase); i > 0; i--) {
+	    min = (int *)tree->Min(&minKey);
+	    item = (int *)tree->RemoveMin(&key);
+	    ASSERT(item == min && key == minKey);
+	    ASSERT(key > lastKey || (key == lastKey && *item > lastItem));
+	    lastKey = key;
+	    lastItem = *item;
+	}
+    }
+    ASSERT(tree->IsEmpty() && tree->NumInTree() == 0);
+
+    delete tree;
+    printf("Red-black tree order: ok\n");
+}
+
+//----------------------------------------------------------------------
+// SRTFTest
+// 	Shortest remaining time first (schedulerCode 14): a thread that
+//	wakes up with less work left than the running thread preempts it,
+//	and runs next; one with more work left does not.  The work left is
+//	the predicted burst less what has run of it.
+//----------------------------------------------------------------------
+
+static void
+SRTFTest()
+{
+    NachOSThread *longJob = new NachOSThread("test", 0);
+    NachOSThread *shortJob = new NachOSThread("test", 0);
+    BurstHistory *savedHistory = burstHistory;
+    double savedAlpha = scheduler->alpha;
+    bool savedAdaptive = scheduler->adaptiveAlpha;
+
+    burstHistory = NULL;		// predictions start from nothing
+    scheduler->alpha = 0.5;
+    scheduler->adaptiveAlpha = FALSE;
+    scheduler->SetPolicy(14, FALSE);
+
+    // Teach the predictions, 100 and 10: 200 ticks between sleeps, and 20
+    scheduler->ThreadIsReadyToRun(longJob);
+    scheduler->ThreadIsReadyToRun(shortJob);
+    ASSERT(Dispatch() == longJob);
+    (void) RunFor(longJob, 200);
+    Block(longJob);
+    ASSERT(Dispatch() == shortJob);
+    (void) RunFor(shortJob, 20);
+    Block(shortJob);
+
+    // The long job wakes while the short one runs: no preemption.  The
+    // short one's prediction becomes 7.5
+    Wake(shortJob);
+    ASSERT(Dispatch() == shortJob);
+    currentThread = shortJob;
+    Wake(longJob);
+    ASSERT(!scheduler->PreemptPending());
+    ASSERT(!RunFor(shortJob, 5));
+    currentThread = NULL;
+    Block(shortJob);
+
+    // The short job wakes while the long one runs: it preempts
+    ASSERT(Dispatch() == longJob);
+    currentThread = longJob;
+    ASSERT(!RunFor(longJob, 30));
+    Wake(shortJob);
+    ASSERT(RunFor(longJob, 1));
+    currentThread = NULL;
+    Preempt(longJob);
+    ASSERT(Dispatch() == shortJob);
+    Block(shortJob);
+
+    // The long job resumes with 69 of its 100 predicted ticks left, and
+    // runs until it has less left than the short job is predicted to take
+    ASSERT(Dispatch() == longJob);
+    currentThread = longJob;
+    (void) RunFor(longJob, 67);
+    Wake(shortJob);
+    ASSERT(!scheduler->PreemptPending());
+    currentThread = NULL;
+    Block(longJob);
+    ASSERT(Dispatch() == shortJob);
+    Block(shortJob);
+
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+    scheduler->alpha = savedAlpha;
+    scheduler->adaptiveAlpha = savedAdaptive;
+    burstHistory = savedHistory;
+    delete longJob;
+    delete shortJob;
+    printf("SRTF preemption: ok\n");
+}
+
+//----------------------------------------------------------------------
+// HeapTest
+// 	The heap behind the ready queues of SJF and the other policies that
+//	pick by key: items come out smallest key first, equal keys in the
+//	order they went in, with removals interleaved with insertions, as
+//	for RBTreeTest.
+//----------------------------------------------------------------------
+
+#define HEAP_TEST_ITEMS		1000
+#define HEAP_TEST_KEYS		50
+
+static void
+HeapTest()
+{
+    Heap *heap = new Heap;
+    int items[HEAP_TEST_ITEMS];
+    int *item, *min;
+    double key, minKey, lastKey;
+    int i, next = 0, lastItem;
+
+    ASSERT(heap->IsEmpty() && heap->RemoveMin(NULL) == NULL);
+
+    for (int phase = 0; phase < 2; phase++) {
+	for (; next < (phase + 1) * HEAP_TEST_ITEMS / 2; next++) {
+	    items[next] = next;
+	    heap->Insert((void *)&items[next], Random() % HEAP_TEST_KEYS);
+	}
+	lastKey = -1;
+	lastItem = -1;
+	for (i = heap->NumInHeap() / (2 - phase); i > 0; i--) {
+	    min = (int *)heap->Min(&minKey);
+	    item = (int *)heap->RemoveMin(&key);
+	    ASSERT(item == min && key == minKey);
+	    ASSERT(key > lastKey || (key == lastKey && *item > lastItem));
+	    lastKey = key;
+	    lastItem = *item;
+	}
+    }
+    ASSERT(heap->IsEmpty() && heap->NumInHeap() == 0);
+
+    delete heap;
+    printf("Heap order: ok\n");
+}
+
+//----------------------------------------------------------------------
+// EDFAdmissionTest
+// 	Earliest deadline first (schedulerCode 15): deadline jobs are
+//	admitted while their reserved shares add up to at most the whole
+//	CPU, and rejected past that; a job that exits gives its share back.
+//	Of the admitted jobs, the one due first runs first.
+//----------------------------------------------------------------------
+
+static void
+EDFAdmissionTest()
+{
+    NachOSThread *periodic, *oneShot;
+
+    scheduler->SetPolicy(15, FALSE);
+
+    // 0.5, then 0.3 more; 0.3 more again is too much, because a period
+    // shorter than the deadline counts; 0.2 fills the CPU exactly
+    ASSERT(scheduler->AdmitDeadline(EDFUtilization(100, 100, 50), 0));
+    ASSERT(scheduler->AdmitDeadline(EDFUtilization(200, 0, 60), 0));
+    ASSERT(!scheduler->AdmitDeadline(EDFUtilization(100, 50, 15), 0));
+    ASSERT(scheduler->AdmitDeadline(EDFUtilization(400, 0, 80), 0));
+    ASSERT(!scheduler->AdmitDeadline(EDFUtilization(1000, 0, 1), 0));
+
+    // The first two jobs run; the one due sooner goes first
+    periodic = new NachOSThread("test", 0);
+    oneShot = new NachOSThread("test", 0);
+    scheduler->DeclareJob(periodic, 0, 100, 100, 50);
+    scheduler->DeclareJob(oneShot, 0, 200, 0, 60);
+    scheduler->ThreadIsReadyToRun(oneShot);
+    scheduler->ThreadIsReadyToRun(periodic);
+    ASSERT(Dispatch() == periodic);
+
+    // Once it exits, its share can go to the job rejected above
+    (void) RunFor(periodic, 50);
+    scheduler->EndBurst(periodic, 50);
+    scheduler->ThreadFinished(periodic);
+    ASSERT(scheduler->AdmitDeadline(EDFUtilization(100, 50, 15), 0));
+    ASSERT(!scheduler->AdmitDeadline(EDFUtilization(100, 0, 21), 0));
+
+    ASSERT(Dispatch() == oneShot);
+    (void) RunFor(oneShot, 60);
+    scheduler->EndBurst(oneShot, 60);
+    scheduler->ThreadFinished(oneShot);
+
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+    delete periodic;
+    delete oneShot;
+    printf("EDF admission control: ok\n");
+}
+
+//----------------------------------------------------------------------
+// WakeupPreemptionTest
+// 	UNIX (schedulerCode 7) and MLFQ (11): a thread that wakes up with
+//	a better priority, or on a better level, than the running thread
+//	asks to preempt it, once; one that wakes up no better does not.
+//----------------------------------------------------------------------
+
+static void
+WakeupPreemptionTest()
+{
+    NachOSThread *good = new NachOSThread("test", 0);
+    NachOSThread *bad = new NachOSThread("test", 40);
+
+    // UNIX: 50 against 90 at the start
+    scheduler->SetPolicy(7, FALSE);
+    scheduler->ThreadIsReadyToRun(good);
+    scheduler->ThreadIsReadyToRun(bad);
+    ASSERT(Dispatch() == good);
+    (void) RunFor(good, 10);
+    Block(good);
+    ASSERT(Dispatch() == bad);
+    currentThread = bad;
+    (void) RunFor(bad, 10);
+    Wake(good);
+    ASSERT(scheduler->PreemptPending());
+    ASSERT(!scheduler->PreemptPending());
+    currentThread = NULL;
+    Block(bad);
+    ASSERT(Dispatch() == good);
+    currentThread = good;
+    Wake(bad);
+    ASSERT(!scheduler->PreemptPending());
+    currentThread = NULL;
+    Block(good);
+    ASSERT(Dispatch() == bad);
+    Block(bad);
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+
+    // MLFQ: bad sinks to level 2, so that it wakes up on level 1
+    stats->totalTicks = (stats->totalTicks / MLFQ_BOOST_PERIOD + 1)
+					* MLFQ_BOOST_PERIOD;
+    scheduler->SetPolicy(11, FALSE);
+    scheduler->ThreadIsReadyToRun(bad);
+    scheduler->ThreadIsReadyToRun(good);
+    ASSERT(Dispatch() == bad);
+    (void) RunFor(bad, MLFQ_BASE_QUANTUM);
+    Preempt(bad);
+    ASSERT(Dispatch() == good);
+    Block(good);
+    ASSERT(Dispatch() == bad);
+    (void) RunFor(bad, MLFQ_BASE_QUANTUM << 1);
+    Preempt(bad);
+    ASSERT(Dispatch() == bad);
+    currentThread = bad;
+    Wake(good);
+    ASSERT(scheduler->PreemptPending());
+    ASSERT(!scheduler->PreemptPending());
+    currentThread = NULL;
+    Block(bad);
+    ASSERT(Dispatch() == good);
+    currentThread = good;
+    Wake(bad);
+    ASSERT(!scheduler->PreemptPending());
+    currentThread = NULL;
+    Block(good);
+    ASSERT(Dispatch() == bad);
+    Block(bad);
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+
+    delete good;
+    delete bad;
+    printf("Wake-up preemption: ok\n");
+}
+
+// Dispatch the next thread as Schedule does; the ticks the policy gives
+// it go to *slice
+
+static NachOSThread *
+DispatchSlice(int *slice)
+{
+    NachOSThread *thread = scheduler->FindNextThreadToRun();
+
+    ASSERT(thread != NULL);
+    *slice = scheduler->StartBurst(thread);
+    return thread;
+}
+
+// End the burst of "thread", which yields, or gives way to a thread that
+// woke up: it has not used up its quantum
+
+static void
+Requeue(NachOSThread *thread)
+{
+    scheduler->EndBurst(thread, stats->totalTicks - thread->curr_cpu_burst_start);
+    scheduler->ThreadIsReadyToRun(thread);
+}
+
+//----------------------------------------------------------------------
+// TSTest
+// 	Time-sharing (schedulerCode 17), with the default dispatch table:
+//	every dispatch is for the quantum of the thread's level, or what
+//	is left of it if the thread was preempted by a thread that woke up,
+//	and the timer says so at that many ticks.  A thread that uses its
+//	quantum up drops ten levels; one that wakes up on a better level
+//	than the running thread preempts it.
+//----------------------------------------------------------------------
+
+static void
+TSTest()
+{
+    NachOSThread *a = new NachOSThread("test", 0);
+    NachOSThread *b = new NachOSThread("test", 0);
+    NachOSThread *c = new NachOSThread("test", 0);
+    char *savedTable = scheduler->dispatchTableFile;
+    int slice;
+
+    scheduler->dispatchTableFile = "no_such_dispatch_table";
+    scheduler->SetPolicy(17, FALSE);
+    scheduler->ThreadIsReadyToRun(a);
+    scheduler->ThreadIsReadyToRun(b);
+    scheduler->ThreadIsReadyToRun(c);
+
+    // a uses up its level 0 quantum, and drops to level 10
+    ASSERT(DispatchSlice(&slice) == a && slice == 20);
+    ASSERT(!RunFor(a, 19));
+    ASSERT(RunFor(a, 1));
+    Preempt(a);
+    ASSERT(DispatchSlice(&slice) == b && slice == 20);
+    (void) RunFor(b, 5);
+    Block(b);
+
+    // b wakes up no better than c, which yields with 15 ticks left
+    ASSERT(DispatchSlice(&slice) == c && slice == 20);
+    currentThread = c;
+    ASSERT(!RunFor(c, 5));
+    Wake(b);
+    ASSERT(!scheduler->PreemptPending());
+    currentThread = NULL;
+    Requeue(c);
+    ASSERT(DispatchSlice(&slice) == b && slice == 20);
+    Block(b);
+    ASSERT(DispatchSlice(&slice) == c && slice == 15);
+    ASSERT(!RunFor(c, 14));
+    ASSERT(RunFor(c, 1));
+    Preempt(c);
+
+    // b wakes up on level 0 while a runs on level 10, and preempts it;
+    // a keeps the rest of its level 10 quantum
+    ASSERT(DispatchSlice(&slice) == a && slice == 40);
+    currentThread = a;
+    ASSERT(!RunFor(a, 10));
+    Wake(b);
+    ASSERT(RunFor(a, 0));
+    currentThread = NULL;
+    Requeue(a);
+    ASSERT(DispatchSlice(&slice) == b && slice == 20);
+    Block(b);
+    ASSERT(DispatchSlice(&slice) == c && slice == 40);
+    Block(c);
+    ASSERT(DispatchSlice(&slice) == a && slice == 30);
+    Block(a);
+
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+    scheduler->dispatchTableFile = savedTable;
+    delete a;
+    delete b;
+    delete c;
+    printf("Time-sharing quanta: ok\n");
+}
+
+//----------------------------------------------------------------------
+// VRRTest
+// 	Virtual round robin (schedulerCode 18): a thread that blocks with
+//	part of its quantum left is dispatched, ahead of the others, for
+//	just that part; otherwise for the whole quantum, which the batch
+//	file can change.
+//----------------------------------------------------------------------
+
+static void
+VRRTest()
+{
+    NachOSThread *a = new NachOSThread("test", 0);
+    NachOSThread *b = new NachOSThread("test", 0);
+    int slice;
+
+    scheduler->SetPolicy(18, FALSE);
+    scheduler->ThreadIsReadyToRun(a);
+    scheduler->ThreadIsReadyToRun(b);
+
+    ASSERT(DispatchSlice(&slice) == a && slice == VRR_QUANTUM);
+    (void) RunFor(a, VRR_QUANTUM);
+    Preempt(a);
+    ASSERT(DispatchSlice(&slice) == b && slice == VRR_QUANTUM);
+    (void) RunFor(b, 25);
+    Block(b);
+
+    // b wakes up while a runs, and goes first for what it had left
+    ASSERT(DispatchSlice(&slice) == a && slice == VRR_QUANTUM);
+    Wake(b);
+    (void) RunFor(a, VRR_QUANTUM);
+    Preempt(a);
+    ASSERT(DispatchSlice(&slice) == b && slice == VRR_QUANTUM - 25);
+    (void) RunFor(b, 10);
+    Block(b);
+    Wake(b);
+    ASSERT(DispatchSlice(&slice) == b && slice == VRR_QUANTUM - 35);
+    (void) RunFor(b, VRR_QUANTUM - 35);
+    Preempt(b);
+
+    // A shorter quantum, as from the batch file
+    scheduler->SetTimerPeriod(30);
+    ASSERT(DispatchSlice(&slice) == a && slice == 30);
+    (void) RunFor(a, 30);
+    Preempt(a);
+    ASSERT(DispatchSlice(&slice) == b && slice == 30);
+    (void) RunFor(b, 10);
+    Block(b);
+    Wake(b);
+    ASSERT(DispatchSlice(&slice) == b && slice == 20);
+    Block(b);
+    ASSERT(DispatchSlice(&slice) == a && slice == 30);
+    Block(a);
+
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+    delete a;
+    delete b;
+    printf("Virtual round robin slices: ok\n");
+}
+
+//----------------------------------------------------------------------
+// DRRTest
+// 	Round robin with a load-adaptive quantum (schedulerCode 19): every
+//	dispatch is for the target latency shared among the runnable
+//	threads, but no less than the minimum granularity, and the timer
+//	says so at that many ticks.
+//----------------------------------------------------------------------
+
+#define DRR_TEST_THREADS	16
+
+static void
+DRRTest()
+{
+    NachOSThread *threads[DRR_TEST_THREADS];
+    NachOSThread *t;
+    int i, runnable, slice, expected;
+
+    scheduler->SetPolicy(19, FALSE);
+    for (i = 0; i < DRR_TEST_THREADS; i++) {
+	threads[i] = new NachOSThread("test", 0);
+	scheduler->ThreadIsReadyToRun(threads[i]);
+    }
+
+    // Each thread blocks in turn, so the slices grow as the load drops
+    for (runnable = DRR_TEST_THREADS; runnable > 0; runnable--) {
+	expected = DRR_TARGET_LATENCY / runnable;
+	if (expected < DRR_MIN_GRANULARITY)
+	    expected = DRR_MIN_GRANULARITY;
+	t = DispatchSlice(&slice);
+	ASSERT(slice == expected);
+	ASSERT(!RunFor(t, slice - 1));
+	ASSERT(RunFor(t, 1));
+	Block(t);
+    }
+    ASSERT(slice == DRR_TARGET_LATENCY);
+
+    for (i = 0; i < DRR_TEST_THREADS; i++)
+	delete threads[i];
+    printf("Dynamic round robin slices: ok\n");
+}
+
+//----------------------------------------------------------------------
+// ReplayTest
+// 	Trace replay: replaying a trace under round robin while recording
+//	it gives back the same jobs, bursts and blocked times (the events
+//	come in schedule order, and the pids are the replay's own); and
+//	replaying that recording gives it back line for line but the pids.
+//----------------------------------------------------------------------
+
+static char replayTrace[3][20] = { "selftest.trace0", "selftest.trace1",
+				   "selftest.trace2" };
+
+// Blank the pid of a trace line, the second field of A lines and the
+// first of the others
+
+static void
+BlankPid(char *line)
+{
+    char *p = line;
+    int field = (line[0] == 'A') ? 2 : 1;
+
+    for (; field > 0 && *p != '\0'; p++)
+	if (*p == ' ')
+	    field--;
+    for (; *p >= '0' && *p <= '9'; p++)
+	*p = 'x';
+}
+
+static void
+ReplayTest()
+{
+    TraceReplay *replay;
+    TraceRecorder *recorder;
+    FILE *fp[2];
+    char line[2][128];
+    int i, lines = 0;
+
+    fp[0] = fopen(replayTrace[0], "w");
+    ASSERT(fp[0] != NULL);
+    fprintf(fp[0], "A 0 1 0 cpu\nA 0 2 0 io\nA 35 3 50 late\n");
+    fprintf(fp[0], "B 2 10 40\nB 2 15 25\nE 2 5\n");
+    fprintf(fp[0], "B 1 170 30\nE 1 90\nE 3 60\n");
+    fclose(fp[0]);
+
+    for (i = 0; i < 2; i++) {
+	replay = new TraceReplay(replayTrace[i]);
+	ASSERT(replay->NumJobs() == 3);
+	recorder = new TraceRecorder(replayTrace[i + 1]);
+	replay->Record(recorder);
+	replay->Run(3, 0);
+	delete recorder;
+	delete replay;
+    }
+
+    fp[0] = fopen(replayTrace[1], "r");
+    fp[1] = fopen(replayTrace[2], "r");
+    ASSERT(fp[0] != NULL && fp[1] != NULL);
+    while (fgets(line[0], sizeof(line[0]), fp[0]) != NULL) {
+	ASSERT(fgets(line[1], sizeof(line[1]), fp[1]) != NULL);
+	BlankPid(line[0]);
+	BlankPid(line[1]);
+	ASSERT(strcmp(line[0], line[1]) == 0);
+	lines++;
+    }
+    ASSERT(fgets(line[1], sizeof(line[1]), fp[1]) == NULL);
+    ASSERT(lines == 9);
+    fclose(fp[0]);
+    fclose(fp[1]);
+
+    for (i = 0; i < 3; i++)
+	remove(replayTrace[i]);
+    printf("Trace replay: ok\n");
+}
+
+//----------------------------------------------------------------------
+// PidTableTest
+// 	The pid table, on a table of its own: pids are handed out densely
+//	from 0, past the table's first size; an exited pid stays reserved
+//	until it is freed; freed pids are reused oldest first; and pid 0
+//	is never reused.
+//----------------------------------------------------------------------
+
+#define PID_TEST_THREADS	(PID_TABLE_MIN_SIZE + 10)
+
+static void
+PidTableTest()
+{
+    PidTable *table = new PidTable;
+    NachOSThread **threads = new NachOSThread*[PID_TEST_THREADS];
+    int i, fresh = PID_TEST_THREADS;
+
+    for (i = 0; i < PID_TEST_THREADS; i++) {
+	threads[i] = new NachOSThread("test", 0);
+	ASSERT(table->Add(threads[i]) == i);
+    }
+    for (i = 0; i < PID_TEST_THREADS; i++)
+	ASSERT(table->Lookup(i) == threads[i]);
+    ASSERT(table->NumLive() == PID_TEST_THREADS);
+
+    // Exited, but not yet joined with: no longer live, not reused
+    table->Exited(5);
+    ASSERT(table->Lookup(5) == NULL);
+    ASSERT(table->NumLive() == PID_TEST_THREADS - 1);
+    ASSERT(table->Add(threads[5]) == fresh++);
+
+    // Freed pids come back in the order they were freed; a live pid
+    // freed is one whose thread was destroyed without running
+    table->Free(7);
+    table->Free(3);
+    table->Free(5);
+    table->Free(PID_TEST_THREADS - 1);
+    ASSERT(table->NumLive() == PID_TEST_THREADS - 3);
+    ASSERT(table->Add(threads[7]) == 7);
+    ASSERT(table->Add(threads[3]) == 3);
+    ASSERT(table->Add(threads[5]) == 5);
+    ASSERT(table->Add(threads[0]) == PID_TEST_THREADS - 1);
+    ASSERT(table->Add(threads[1]) == fresh++);
+    ASSERT(table->Lookup(5) == threads[5]);
+
+    // Pid 0 stays reserved
+    table->Free(0);
+    ASSERT(table->Lookup(0) == NULL);
+    ASSERT(table->Add(threads[2]) == fresh++);
+
+    for (i = 0; i < PID_TEST_THREADS; i++)
+	delete threads[i];
+    delete [] threads;
+    delete table;
+    printf("Pid table reuse order: ok\n");
+}
+
+//----------------------------------------------------------------------
+// ChildTableTest
+// 	A thread's table of children: it grows to hold any number of them,
+//	keeping what it knows of each (exit codes included) as it grows;
+//	its walk visits every child once; a reused pid takes over the old
+//	record; and it empties again as the children are joined.
+//----------------------------------------------------------------------
+
+#define CHILD_TEST_CHILDREN	(20 * CHILD_TABLE_MIN_SIZE)
+
+static void
+ChildTableTest()
+{
+    ChildTable *children = new ChildTable;
+    ChildRecord *record;
+    int i, seen;
+
+    ASSERT(children->Next(NULL) == NULL);
+
+    // The first children exit before the table has to grow
+    for (i = 0; i < CHILD_TABLE_MIN_SIZE; i++) {
+	children->Add(3 * i + 1);
+	record = children->Lookup(3 * i + 1);
+	record->exited = TRUE;
+	record->exitCode = i;
+    }
+    for (i = CHILD_TABLE_MIN_SIZE; i < CHILD_TEST_CHILDREN; i++)
+	children->Add(3 * i + 1);
+    ASSERT(children->NumChildren() == CHILD_TEST_CHILDREN);
+    for (i = 0; i < CHILD_TEST_CHILDREN; i++) {
+	record = children->Lookup(3 * i + 1);
+	ASSERT(record != NULL && record->pid == 3 * i + 1);
+	ASSERT(record->exited == (i < CHILD_TABLE_MIN_SIZE));
+	if (i < CHILD_TABLE_MIN_SIZE)
+	    ASSERT(record->exitCode == i);
+	ASSERT(children->Lookup(3 * i + 2) == NULL);
+    }
+
+    // Every child once, in whatever order
+    seen = 0;
+    for (record = children->Next(NULL); record != NULL;
+				record = children->Next(record)) {
+	ASSERT(record->pid % 3 == 1 && record->pid < 3 * CHILD_TEST_CHILDREN);
+	seen++;
+    }
+    ASSERT(seen == CHILD_TEST_CHILDREN);
+
+    // A pid reused by a new child: the same record, not exited
+    children->Add(1);
+    ASSERT(children->NumChildren() == CHILD_TEST_CHILDREN);
+    ASSERT(!children->Lookup(1)->exited);
+
+    // Joined with, one by one, down to none, and ready for more
+    for (i = 0; i < CHILD_TEST_CHILDREN; i++) {
+	children->Remove(3 * i + 1);
+	ASSERT(children->Lookup(3 * i + 1) == NULL);
+    }
+    ASSERT(children->NumChildren() == 0);
+    ASSERT(children->Next(NULL) == NULL);
+    children->Add(7);
+    ASSERT(children->Lookup(7) != NULL && children->NumChildren() == 1);
+
+    delete children;
+    printf("Child table growth: ok\n");
+}
+
+//----------------------------------------------------------------------
+// PerCPUSliceTest
+// 	With several CPUs the timer cannot be reprogrammed for one thread's
+//	slice (virtual round robin here), so a CPU keeps the end of the
+//	slice: the shared timer going off sooner does not preempt the
+//	thread, and the CPU preempts it at that end.  Without a slice of
+//	its own, the policy decides on every timer interrupt.
+//----------------------------------------------------------------------
+
+static void
+PerCPUSliceTest()
+{
+    Processor *cpu = new Processor(0, scheduler);
+    NachOSThread *a = new NachOSThread("test", 0);
+    NachOSThread *b = new NachOSThread("test", 0);
+    int slice;
+
+    scheduler->SetPolicy(18, FALSE);
+    scheduler->ThreadIsReadyToRun(a);
+    scheduler->ThreadIsReadyToRun(b);
+
+    ASSERT(DispatchSlice(&slice) == a && slice == VRR_QUANTUM);
+    cpu->StartSlice(slice);
+    stats->totalTicks += VRR_QUANTUM / 2;
+    ASSERT(!cpu->ShouldPreempt(a));
+    stats->totalTicks += VRR_QUANTUM - VRR_QUANTUM / 2 - 1;
+    ASSERT(!cpu->ShouldPreempt(a));
+    stats->totalTicks++;
+    ASSERT(cpu->ShouldPreempt(a) && cpu->sliceEnd == 0);
+    Preempt(a);
+
+    // b blocks 20 ticks in, and comes back for the other 40 only
+    ASSERT(DispatchSlice(&slice) == b);
+    cpu->StartSlice(slice);
+    stats->totalTicks += 20;
+    Block(b);
+    Wake(b);
+    ASSERT(DispatchSlice(&slice) == b && slice == VRR_QUANTUM - 20);
+    cpu->StartSlice(slice);
+    stats->totalTicks += VRR_QUANTUM / 2;
+    ASSERT(!cpu->ShouldPreempt(b));
+    stats->totalTicks += VRR_QUANTUM - 20 - VRR_QUANTUM / 2;
+    ASSERT(cpu->ShouldPreempt(b));
+    Preempt(b);
+
+    // No slice: round robin preempts at once
+    ASSERT(DispatchSlice(&slice) == a);
+    cpu->StartSlice(0);
+    ASSERT(cpu->ShouldPreempt(a));
+    Block(a);
+    ASSERT(DispatchSlice(&slice) == b);
+    Block(b);
+
+    ASSERT(scheduler->FindNextThreadToRun() == NULL);
+    delete a;
+    delete b;
+    delete cpu;
+    printf("Per-CPU slices: ok\n");
+}
+
+//----------------------------------------------------------------------
+// SelfTest
+// 	Run the self-tests above, then put back the scheduling policy and
+//	the simulated time they changed.  The running thread is hidden
+//	meanwhile, so that the test threads are nobody's children, and
+//	never preempt it.
+//----------------------------------------------------------------------
+
+void
+SelfTest()
+{
+    int savedCode = scheduler->schedulerCode;
+    bool savedByGroup = scheduler->groupScheduling;
+    int savedTicks = stats->totalTicks;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    NachOSThread *saved = currentThread;
+
+    currentThread = NULL;
+    UnixDecayTest();
+    MLFQTest();
+    StrideTest();
+    RBTreeTest();
+    SRTFTest();
+    HeapTest();
+    EDFAdmissionTest();
+    WakeupPreemptionTest();
+    TSTest();
+    VRRTest();
+    DRRTest();
+    ReplayTest();
+    PidTableTest();
+    ChildTableTest();
+    PerCPUSliceTest();
+    currentThread = saved;
+
+    scheduler->SetPolicy(savedCode, savedByGroup);
+    stats->totalTicks = savedTicks;
+    (void) interrupt->SetLevel(oldLevel);
+}
@@ -0,0 +1,506 @@
+// trace.cc
+//	Routines to record the CPU bursts and blocked times of jobs, and to
+//	replay them under a scheduling policy.  See trace.h.
+//
+//	A replay swaps in statistics and a scheduler of its own, and puts
+//	the real ones back when it is done; it runs no threads, so the
+//	kernel never notices.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "trace.h"
+#include "system.h"
+
+//----------------------------------------------------------------------
+// TraceRecorder::TraceRecorder
+//	Create the trace file "fileName", replacing any old one.
+//----------------------------------------------------------------------
+
+TraceRecorder::TraceRecorder(char *fileName)
+{
+    fp = fopen(fileName, "w");
+    if (fp == NULL)
+	printf("Unable to open trace file %s\n", fileName);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    if (fp != NULL)
+	fclose(fp);
+}
+
+//----------------------------------------------------------------------
+// TraceRecorder::Arrived
+//	Note a new job.  The main thread, which only loads the batch, is
+//	not a job.
+//----------------------------------------------------------------------
+
+void
+TraceRecorder::Arrived(NachOSThread *thread)
+{
+    char *name = (thread->execName != NULL) ? thread->execName
+					    : thread->getName();
+
+    if (fp != NULL && thread->GetPID() > 0)
+	fprintf(fp, "A %d %d %d %s\n", stats->totalTicks, thread->GetPID(),
+		thread->batchPriority, name);
+}
+
+//----------------------------------------------------------------------
+// TraceRecorder::Ran
+//	Add up the bursts of a thread until it blocks, whatever the
+//	preemptions, and hold on to the sum until we know how long the
+//	thread blocks.
+//----------------------------------------------------------------------
+
+void
+TraceRecorder::Ran(NachOSThread *thread, int burst)
+{
+    thread->traceBurst += burst;
+    if (thread->getStatus() == BLOCKED)
+	thread->curr_block_start = stats->totalTicks;
+}
+
+void
+TraceRecorder::Woken(NachOSThread *thread)
+{
+    if (fp != NULL && thread->GetPID() > 0)
+	fprintf(fp, "B %d %d %d\n", thread->GetPID(), thread->traceBurst,
+		stats->totalTicks - thread->curr_block_start);
+    thread->traceBurst = 0;
+}
+
+void
+TraceRecorder::Exited(NachOSThread *thread)
+{
+    if (fp != NULL && thread->GetPID() > 0)
+	fprintf(fp, "E %d %d\n", thread->GetPID(), thread->traceBurst);
+}
+
+//----------------------------------------------------------------------
+// TraceJob::TraceJob
+//	A job arriving at tick "jobArrival", with no bursts yet.
+//----------------------------------------------------------------------
+
+TraceJob::TraceJob(int jobArrival, int jobPriority, char *jobName)
+{
+    arrival = jobArrival;
+    priority = jobPriority;
+    strncpy(name, jobName, TRACE_NAME_LEN - 1);
+    name[TRACE_NAME_LEN - 1] = '\0';
+    maxBursts = 8;
+    cpu = new int[maxBursts];
+    blocked = new int[maxBursts];
+    numBursts = 0;
+    thread = NULL;
+}
+
+TraceJob::~TraceJob()
+{
+    delete [] cpu;
+    delete [] blocked;
+}
+
+void
+TraceJob::AddBurst(int cpuTicks, int blockedTicks)
+{
+    if (numBursts == maxBursts) {
+	int *newCpu = new int[2 * maxBursts];
+	int *newBlocked = new int[2 * maxBursts];
+
+	for (int i = 0; i < numBursts; i++) {
+	    newCpu[i] = cpu[i];
+	    newBlocked[i] = blocked[i];
+	}
+	delete [] cpu;
+	delete [] blocked;
+	cpu = newCpu;
+	blocked = newBlocked;
+	maxBursts *= 2;
+    }
+    cpu[numBursts] = cpuTicks;
+    blocked[numBursts] = blockedTicks;
+    numBursts++;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::TraceReplay
+//	Load the trace in "fileName".  Lines that do not parse, or name a
+//	job that never arrived, are skipped; a job whose exit is missing
+//	ends after its last burst.
+//----------------------------------------------------------------------
+
+TraceReplay::TraceReplay(char *fileName)
+{
+    FILE *fp = fopen(fileName, "r");
+    char line[128], name[TRACE_NAME_LEN];
+    TraceJob **byPid = NULL;		// the job of each pid in the trace
+    int byPidSize = 0;
+    int tick, pid, priority, cpuTicks, blockedTicks;
+    TraceJob *job;
+
+    jobs = new List;
+    numJobs = 0;
+    sched = NULL;
+    recorder = NULL;
+    events = NULL;
+    jobOfThread = NULL;
+    jobOfThreadSize = 0;
+    if (fp == NULL) {
+	printf("Unable to open trace file %s\n", fileName);
+	return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+	if (sscanf(line, "A %d %d %d %63[^\n]", &tick, &pid, &priority,
+		   name) == 4 && pid >= 0) {
+	    if (pid >= byPidSize) {
+		int newSize = (pid + 1) * 2;
+		TraceJob **newByPid = new TraceJob *[newSize];
+
+		for (int i = 0; i < newSize; i++)
+		    newByPid[i] = (i < byPidSize) ? byPid[i] : NULL;
+		delete [] byPid;
+		byPid = newByPid;
+		byPidSize = newSize;
+	    }
+	    byPid[pid] = job = new TraceJob(tick, priority, name);
+	    jobs->Append((void *)job);
+	    numJobs++;
+	    continue;
+	}
+	if (sscanf(line, "B %d %d %d", &pid, &cpuTicks, &blockedTicks) != 3) {
+	    if (sscanf(line, "E %d %d", &pid, &cpuTicks) != 2)
+		continue;
+	    blockedTicks = -1;
+	}
+	if (pid >= 0 && pid < byPidSize && byPid[pid] != NULL
+		&& cpuTicks >= 0)
+	    byPid[pid]->AddBurst(cpuTicks, blockedTicks);
+    }
+    fclose(fp);
+    delete [] byPid;
+    DEBUG('t', "Loaded %d jobs from trace %s\n", numJobs, fileName);
+}
+
+TraceReplay::~TraceReplay()
+{
+    TraceJob *job;
+
+    while ((job = (TraceJob *)jobs->Remove()) != NULL)
+	delete job;
+    delete jobs;
+    delete [] jobOfThread;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::Run
+//	Replay the trace under schedulerCode "code", with the scheduler's
+//	timer programmed for "period" (0 for the policy's own period),
+//	on one CPU.  Print a line of results: the ticks to finish, CPU
+//	utilization, the average, maximum and 99th percentile of the jobs'
+//	total waits, the dispatches, and the host time the replay took.
+//
+//	The SJF, SRTF and UNIX tuning of the real scheduler (alpha, aging)
+//	and its dispatch table carry over; the burst history and the trace
+//	being recorded, if any, are left alone.  The replay goes into a
+//	trace only if one was given to Record.
+//----------------------------------------------------------------------
+
+void
+TraceReplay::Run(int code, int period)
+{
+    Statistics *savedStats = stats;
+    NachOSThread *savedThread = currentThread;
+    BurstHistory *savedHistory = burstHistory;
+    TraceRecorder *savedRecorder = traceRecorder;
+    double start = HostTime();
+    TraceJob *job;
+
+    stats = new Statistics();
+    sched = new NachOSscheduler();
+    sched->alpha = scheduler->alpha;
+    sched->adaptiveAlpha = scheduler->adaptiveAlpha;
+    sched->agingRate = scheduler->agingRate;
+    sched->dispatchTableFile = scheduler->dispatchTableFile;
+    sched->SetPolicy(code, FALSE);
+    if (period > 0)
+	sched->SetTimerPeriod(period);
+    quantum = sched->TimerPeriod();
+    currentThread = NULL;
+    burstHistory = NULL;		// the replay teaches it nothing
+    traceRecorder = recorder;		// nor goes into a trace, unless asked
+
+    events = new List;
+    jobsLeft = 0;
+    for (ListElement *ptr = jobs->first; ptr != NULL; ptr = ptr->next) {
+	job = (TraceJob *)ptr->item;
+	if (job->numBursts > 0) {
+	    events->SortedInsert((void *)job, job->arrival);
+	    jobsLeft++;
+	}
+    }
+    running = NULL;
+    nextTick = quantum;
+    nextClock = TimerTicks;
+    dispatches = 0;
+    if (!events->IsEmpty())
+	stats->totalTicks = events->first->key;	// start with the first job
+    RunEvents();
+
+    while (jobsLeft > 0) {
+	if (running == NULL) {
+	    StartTimers();
+	    Dispatch();
+	}
+	if (running == NULL) {		// idle until a job arrives or wakes
+	    int when = NextEvent();
+
+	    ASSERT(when >= 0);
+	    stats->idleTicks += when - stats->totalTicks;
+	    stats->totalTicks = when;
+	    RunEvents();
+	    continue;
+	}
+
+	// Run until the burst is done, a timer goes off or a job is due
+	int until = stats->totalTicks + running->left;
+	int when = NextEvent();
+	bool yield = FALSE;
+
+	if (nextTick < until)
+	    until = nextTick;
+	if (nextClock < until)
+	    until = nextClock;
+	if (when >= 0 && when < until)
+	    until = when;
+	running->left -= until - stats->totalTicks;
+	stats->userTicks += until - stats->totalTicks;
+	stats->totalTicks = until;
+
+	if (running->left == 0)
+	    EndBurst();
+	if (RunEvents() && running != NULL && sched->PreemptPending()) {
+	    stats->wakeup_preemptions++;
+	    yield = TRUE;
+	}
+	if (running == NULL)
+	    continue;
+
+	// As on a uniprocessor, all causes end up in a single yield
+	if (stats->totalTicks >= nextTick) {
+	    nextTick = stats->totalTicks + quantum;
+	    if (sched->ShouldPreempt(running->thread)) {
+		running->thread->yieldAt = TRUE;
+		yield = TRUE;
+	    }
+	}
+	if (stats->totalTicks >= nextClock) {
+	    nextClock = stats->totalTicks + TimerTicks;
+	    yield = TRUE;
+	}
+	if (yield)
+	    Yield();
+    }
+
+    double util = (stats->totalTicks - stats->idleTicks)
+	/ (double)stats->totalTicks;
+    printf("%d, %d, %d, %d, %f, %f, %d, %d, %d, %.3f\n", code, quantum,
+	   stats->thread_count, stats->totalTicks, util,
+	   stats->wait_time_total / (double)stats->thread_count,
+	   stats->thread_wait_max,
+	   WaitPercentile(stats->thread_wait_hist, stats->thread_count,
+			  stats->thread_wait_max, 99.0),
+	   dispatches, (HostTime() - start) * 1e3);
+
+    delete events;
+    delete sched;
+    delete stats;
+    sched = NULL;
+    events = NULL;
+    stats = savedStats;
+    currentThread = savedThread;
+    burstHistory = savedHistory;
+    traceRecorder = savedRecorder;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::Dispatch
+//	Give the idle CPU to the next ready thread, if there is one.
+//----------------------------------------------------------------------
+
+void
+TraceReplay::Dispatch()
+{
+    NachOSThread *thread = sched->FindNextThreadToRun();
+
+    if (thread != NULL)
+	Switch(thread);
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::Switch
+//	Run "thread", just taken off the ready queue, as Schedule would.
+//----------------------------------------------------------------------
+
+void
+TraceReplay::Switch(NachOSThread *thread)
+{
+    int slice;
+
+    running = jobOfThread[thread->GetPID()];
+    currentThread = thread;
+    slice = sched->StartBurst(thread);
+    if (slice > 0)
+	nextTick = stats->totalTicks + slice;	// the timer is reprogrammed
+    dispatches++;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::Yield
+//	The running thread gives up the CPU, as in NachOSThread::YieldCPU:
+//	a preempted thread (yieldAt) is queued before the next thread is
+//	picked, so it may be picked again; one that yields is queued after.
+//----------------------------------------------------------------------
+
+void
+TraceReplay::Yield()
+{
+    NachOSThread *thread = running->thread;
+    NachOSThread *nextThread;
+
+    sched->EndBurst(thread, stats->totalTicks - thread->curr_cpu_burst_start);
+    if (thread->yieldAt)
+	sched->ThreadIsReadyToRun(thread);
+    nextThread = sched->FindNextThreadToRun();
+    if (nextThread != NULL) {
+	if (thread->yieldAt)
+	    thread->yieldAt = FALSE;
+	else
+	    sched->ThreadIsReadyToRun(thread);
+	Switch(nextThread);
+    }
+    thread->curr_cpu_burst_start = stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::EndBurst
+//	The running thread has computed its whole burst.  It blocks for
+//	the recorded time, or, after its last burst, exits.
+//----------------------------------------------------------------------
+
+void
+TraceReplay::EndBurst()
+{
+    TraceJob *job = running;
+    NachOSThread *thread = job->thread;
+    int burst = stats->totalTicks - thread->curr_cpu_burst_start;
+
+    thread->setStatus(BLOCKED);
+    running = NULL;
+    currentThread = NULL;
+    if (job->next + 1 < job->numBursts && job->blocked[job->next] >= 0) {
+	sched->EndBurst(thread, burst);
+	thread->blockCount++;
+	events->SortedInsert((void *)job,
+			     stats->totalTicks + job->blocked[job->next]);
+	job->next++;
+	job->left = job->cpu[job->next];
+	return;
+    }
+
+    stats->thread_count++;
+    stats->wait_time_total += thread->wait_time_sum;
+    stats->RecordThreadWait(thread->wait_time_sum);
+    sched->EndBurst(thread, burst);
+    sched->ThreadFinished(thread);
+    jobOfThread[thread->GetPID()] = NULL;
+    delete thread;			// frees its pid
+    job->thread = NULL;
+    jobsLeft--;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::RunEvents
+//	Make ready every job that arrives or wakes up by now.  An arriving
+//	job gets a thread, with its recorded batch priority.
+//----------------------------------------------------------------------
+
+bool
+TraceReplay::RunEvents()
+{
+    NachOSThread *thread, *current = currentThread;
+    TraceJob *job;
+    int when;
+    bool any = FALSE;
+
+    while (!events->IsEmpty() && events->first->key <= stats->totalTicks) {
+	job = (TraceJob *)events->SortedRemove(&when);
+	if (job->thread == NULL) {
+	    currentThread = NULL;		// not anyone's child
+	    thread = new NachOSThread(job->name, job->priority);
+	    currentThread = current;
+	    if (thread->GetPID() >= jobOfThreadSize) {
+		int newSize = (thread->GetPID() + 1) * 2;
+		TraceJob **newJobOf = new TraceJob *[newSize];
+
+		for (int i = 0; i < newSize; i++)
+		    newJobOf[i] = (i < jobOfThreadSize) ? jobOfThread[i] : NULL;
+		delete [] jobOfThread;
+		jobOfThread = newJobOf;
+		jobOfThreadSize = newSize;
+	    }
+	    jobOfThread[thread->GetPID()] = job;
+	    job->thread = thread;
+	    job->next = 0;
+	    job->left = job->cpu[0];
+	}
+	sched->ThreadIsReadyToRun(job->thread);
+	any = TRUE;
+    }
+    return any;
+}
+
+int
+TraceReplay::NextEvent()
+{
+    return events->IsEmpty() ? -1 : events->first->key;
+}
+
+//----------------------------------------------------------------------
+// TraceReplay::StartTimers
+//	Move the timer interrupts that went off while no thread ran past
+//	now; the timers keep their phase.
+//----------------------------------------------------------------------
+
+void
+TraceReplay::StartTimers()
+{
+    while (nextTick <= stats->totalTicks)
+	nextTick += quantum;
+    while (nextClock <= stats->totalTicks)
+	nextClock += TimerTicks;
+}
+
+//----------------------------------------------------------------------
+// ReplayTrace
+//	Replay the trace in "fileName" once, under schedulerCode "code"
+//	with the timer programmed for "quantum" (0 for the policy's own),
+//	and print the results under a header line.
+//----------------------------------------------------------------------
+
+void
+ReplayTrace(char *fileName, int code, int quantum)
+{
+    TraceReplay *replay = new TraceReplay(fileName);
+
+    if (replay->NumJobs() > 0) {
+	printf("schedulerCode, quantum, jobs, ticks, utilization, "
+	       "average wait, maximum wait, 99th percentile wait, "
+	       "dispatches, host ms\n");
+	replay->Run(code, quantum);
+    }
+    delete replay;
+}
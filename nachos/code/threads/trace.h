@@ -0,0 +1,129 @@
+// trace.h
+//	Data structures for recording how jobs use the CPU, and for
+//	replaying the recording under any scheduling policy without
+//	running MIPS code.
+//
+//	Evaluating a policy on a batch means interpreting every user
+//	instruction, but all a policy ever sees of a job is when it arrives,
+//	how long it computes between blocking calls, and how long it stays
+//	blocked.  With -trace, Nachos writes that to a host file, one line
+//	per event:
+//
+//		A <tick> <pid> <priority> <name>	job made ready the first time
+//		B <pid> <cpu ticks> <blocked ticks>	it computed, then blocked
+//		E <pid> <cpu ticks>			it computed, then exited
+//
+//	The CPU ticks are those between blocking calls, whatever the
+//	preemptions.  A replay (-R) feeds the jobs to the ready queue of a
+//	scheduler of its own and runs a discrete-event clock: the CPU goes
+//	to a thread for the rest of its burst, or until the next timer
+//	interrupt, arrival or wake-up.  Blocked times and the arrival of
+//	forked children are replayed as recorded, so waits that depend on
+//	the schedule (Join) are only approximated.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+#include "scheduler.h"
+
+#define TRACE_NAME_LEN		64
+
+// The following class writes a trace while Nachos runs.  The scheduler
+// calls it on every arrival, burst, wake-up and exit.
+
+class TraceRecorder {
+  public:
+    TraceRecorder(char *fileName);	// start the trace in "fileName"
+    ~TraceRecorder();			// and finish it
+
+    void Arrived(NachOSThread *thread);	// made ready the first time
+    void Ran(NachOSThread *thread, int burst);
+					// ran "burst" ticks; it blocks (or
+					// exits) if it is BLOCKED
+    void Woken(NachOSThread *thread);	// made ready after blocking
+    void Exited(NachOSThread *thread);
+
+  private:
+    FILE *fp;				// NULL if the file could not be made
+};
+
+// One job of a trace, and its state while being replayed.
+
+class TraceJob {
+  public:
+    TraceJob(int jobArrival, int jobPriority, char *jobName);
+    ~TraceJob();
+
+    void AddBurst(int cpu, int blocked);	// "blocked" is -1 after the
+						// last burst
+
+    int arrival;			// tick it was first made ready
+    int priority;			// its batch priority
+    char name[TRACE_NAME_LEN];
+    int *cpu;				// CPU ticks of each burst
+    int *blocked;			// ticks blocked after each burst
+    int numBursts;
+    int maxBursts;			// room in cpu[] and blocked[]
+
+    NachOSThread *thread;		// replaying it, NULL if not arrived
+					// or exited
+    int next;				// the burst being replayed
+    int left;				// CPU ticks left of it
+};
+
+// The following class replays a trace, as often as wanted, each time
+// under a given policy and quantum.
+
+class TraceReplay {
+  public:
+    TraceReplay(char *fileName);	// load the trace in "fileName"
+    ~TraceReplay();
+
+    int NumJobs() { return numJobs; }	// 0 if the trace could not be read
+    void Run(int code, int period);	// replay it under schedulerCode
+					// "code", and print the results;
+					// period 0 is the policy's own
+    void Record(TraceRecorder *to) { recorder = to; }
+					// trace the replays into "to"
+
+  private:
+    void Dispatch();			// run the next ready thread, if any
+    void Switch(NachOSThread *thread);	// run "thread", off the ready queue
+    void Yield();			// the running thread gives up the CPU
+    void EndBurst();			// the running thread has done its
+					// burst: block or exit
+    bool RunEvents();			// make ready the jobs due now;
+					// FALSE if there were none
+    int NextEvent();			// tick of the next one, -1 if none
+    void StartTimers();			// timer interrupts while the CPU
+					// had no thread are lost
+
+    List *jobs;				// TraceJobs, in order of arrival
+    int numJobs;
+
+    NachOSscheduler *sched;		// the scheduler being replayed
+    List *events;			// TraceJobs to make ready, by tick
+    TraceJob *running;			// NULL if the CPU is idle
+    TraceJob **jobOfThread;		// the job of each pid in the replay
+    int jobOfThreadSize;
+    int quantum;			// period of the scheduler's timer
+    int nextTick;			// its next interrupt
+    int nextClock;			// next interrupt of the system timer,
+					// which makes the running thread yield
+    int jobsLeft;			// jobs that have not exited
+    int dispatches;
+    TraceRecorder *recorder;		// where the replays are traced, NULL
+					// for nowhere
+};
+
+extern void ReplayTrace(char *fileName, int code, int quantum);
+					// load a trace and replay it once
+
+#endif // TRACE_H
@@ -61,9 +61,6 @@ ProcessAddrSpace::ProcessAddrSpace(OpenFile *executable)
 {
     NoffHeader noffH;
     unsigned int i, size;
-    unsigned vpn, offset;
-    TranslationEntry *entry;
-    unsigned int pageFrame;
 
     executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
     if ((noffH.noffMagic != NOFFMAGIC) && 
@@ -78,7 +75,7 @@ ProcessAddrSpace::ProcessAddrSpace(OpenFile *executable)
     numPagesInVM = divRoundUp(size, PageSize);
     size = numPagesInVM * PageSize;
 
-    ASSERT(numPagesInVM+numPagesAllocated <= NumPhysPages);		// check we're not trying
+    ASSERT(numPagesInVM <= (unsigned)physFrameMap->NumClear());	// check we're not trying
 						// to run anything too big --
 						// at least until we have
 						// virtual memory
@@ -89,18 +86,19 @@ ProcessAddrSpace::ProcessAddrSpace(OpenFile *executable)
     NachOSpageTable = new TranslationEntry[numPagesInVM];
     for (i = 0; i < numPagesInVM; i++) {
 	NachOSpageTable[i].virtualPage = i;
-	NachOSpageTable[i].physicalPage = i+numPagesAllocated;
+	NachOSpageTable[i].physicalPage = physFrameMap->Find();
 	NachOSpageTable[i].valid = TRUE;
 	NachOSpageTable[i].use = FALSE;
 	NachOSpageTable[i].dirty = FALSE;
 	NachOSpageTable[i].readOnly = FALSE;  // if the code segment was entirely on 
 					// a separate page, we could set its 
 					// pages to be read-only
-    }
-    
+
 // zero out the entire address space, to zero the unitialized data segment 
 // and the stack segment
-    bzero(&machine->mainMemory[numPagesAllocated*PageSize], size);
+	bzero(&machine->mainMemory[NachOSpageTable[i].physicalPage * PageSize],
+							PageSize);
+    }
 
     numPagesAllocated += numPagesInVM;
 
@@ -108,22 +106,14 @@ ProcessAddrSpace::ProcessAddrSpace(OpenFile *executable)
     if (noffH.code.size > 0) {
         DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
 			noffH.code.virtualAddr, noffH.code.size);
-        vpn = noffH.code.virtualAddr/PageSize;
-        offset = noffH.code.virtualAddr%PageSize;
-        entry = &NachOSpageTable[vpn];
-        pageFrame = entry->physicalPage;
-        executable->ReadAt(&(machine->mainMemory[pageFrame * PageSize + offset]),
-                        noffH.code.size, noffH.code.inFileAddr);
+        LoadSegment(executable, noffH.code.virtualAddr, noffH.code.size,
+                        noffH.code.inFileAddr);
     }
     if (noffH.initData.size > 0) {
         DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
 			noffH.initData.virtualAddr, noffH.initData.size);
-        vpn = noffH.initData.virtualAddr/PageSize;
-        offset = noffH.initData.virtualAddr%PageSize;
-        entry = &NachOSpageTable[vpn];
-        pageFrame = entry->physicalPage;
-        executable->ReadAt(&(machine->mainMemory[pageFrame * PageSize + offset]),
-                        noffH.initData.size, noffH.initData.inFileAddr);
+        LoadSegment(executable, noffH.initData.virtualAddr, noffH.initData.size,
+                        noffH.initData.inFileAddr);
     }
 
 }
@@ -136,9 +126,10 @@ ProcessAddrSpace::ProcessAddrSpace(OpenFile *executable)
 ProcessAddrSpace::ProcessAddrSpace(ProcessAddrSpace *parentSpace)
 {
     numPagesInVM = parentSpace->GetNumPages();
-    unsigned i, size = numPagesInVM * PageSize;
+    unsigned i, j, size = numPagesInVM * PageSize;
+    unsigned parentFrame, childFrame;
 
-    ASSERT(numPagesInVM+numPagesAllocated <= NumPhysPages);                // check we're not trying
+    ASSERT(numPagesInVM <= (unsigned)physFrameMap->NumClear());          // check we're not trying
 
 // to run anything too big --
 
@@ -154,20 +145,20 @@ ProcessAddrSpace::ProcessAddrSpace(ProcessAddrSpace *parentSpace)
     NachOSpageTable = new TranslationEntry[numPagesInVM];
     for (i = 0; i < numPagesInVM; i++) {
         NachOSpageTable[i].virtualPage = i;
-        NachOSpageTable[i].physicalPage = i+numPagesAllocated;
+        NachOSpageTable[i].physicalPage = physFrameMap->Find();
         NachOSpageTable[i].valid = parentPageTable[i].valid;
         NachOSpageTable[i].use = parentPageTable[i].use;
         NachOSpageTable[i].dirty = parentPageTable[i].dirty;
         NachOSpageTable[i].readOnly = parentPageTable[i].readOnly;    // if the code segment was entirely on
                                                                 // a separate page, we could set its
                                                                 // pages to be read-only
-    }
 
-    // Copy the contents
-    unsigned startAddrParent = parentPageTable[0].physicalPage*PageSize;
-    unsigned startAddrChild = numPagesAllocated*PageSize;
-    for (i=0; i<size; i++) {
-       machine->mainMemory[startAddrChild+i] = machine->mainMemory[startAddrParent+i];
+        // Copy the contents, a frame at a time
+        parentFrame = parentPageTable[i].physicalPage*PageSize;
+        childFrame = NachOSpageTable[i].physicalPage*PageSize;
+        for (j=0; j<PageSize; j++) {
+           machine->mainMemory[childFrame+j] = machine->mainMemory[parentFrame+j];
+        }
     }
 
     numPagesAllocated += numPagesInVM;
@@ -175,12 +166,45 @@ ProcessAddrSpace::ProcessAddrSpace(ProcessAddrSpace *parentSpace)
 
 //----------------------------------------------------------------------
 // ProcessAddrSpace::~ProcessAddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space, giving its frames back for the
+//	next address space to use.
 //----------------------------------------------------------------------
 
 ProcessAddrSpace::~ProcessAddrSpace()
 {
-   delete NachOSpageTable;
+   for (unsigned i = 0; i < numPagesInVM; i++)
+      physFrameMap->Clear(NachOSpageTable[i].physicalPage);
+   numPagesAllocated -= numPagesInVM;
+   delete [] NachOSpageTable;
+}
+
+//----------------------------------------------------------------------
+// ProcessAddrSpace::LoadSegment
+// 	Copy "size" bytes at "inFileAddr" in "executable" to the virtual
+//	address "virtualAddr".  The frames of an address space are
+//	wherever there were free ones, so this goes a page at a time.
+//----------------------------------------------------------------------
+
+void
+ProcessAddrSpace::LoadSegment(OpenFile *executable, int virtualAddr,
+			      int size, int inFileAddr)
+{
+    int chunk;
+    unsigned vpn, offset, pageFrame;
+
+    while (size > 0) {
+        vpn = virtualAddr/PageSize;
+        offset = virtualAddr%PageSize;
+        pageFrame = NachOSpageTable[vpn].physicalPage;
+        chunk = PageSize - offset;
+        if (chunk > size)
+            chunk = size;
+        executable->ReadAt(&(machine->mainMemory[pageFrame * PageSize + offset]),
+                        chunk, inFileAddr);
+        virtualAddr += chunk;
+        inFileAddr += chunk;
+        size -= chunk;
+    }
 }
 
 //----------------------------------------------------------------------
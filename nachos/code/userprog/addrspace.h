@@ -39,6 +39,10 @@ class ProcessAddrSpace {
     TranslationEntry* GetPageTable();
 
   private:
+    void LoadSegment(OpenFile *executable, int virtualAddr, int size,
+                     int inFileAddr);	// copy a segment of "executable"
+					// into the address space
+
     TranslationEntry *NachOSpageTable;	// Assume linear page table translation
 					// for now!
     unsigned int numPagesInVM;		// Number of pages in the virtual 
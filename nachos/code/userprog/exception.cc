@@ -109,13 +109,10 @@ ExceptionHandler(ExceptionType which)
        // We do not wait for the children to finish.
        // The children will continue to run.
        // We will worry about this when and if we implement signals.
-       exitThreadArray[currentThread->GetPID()] = true;
+       pidTable->Exited(currentThread->GetPID());
 
        // Find out if all threads have called exit
-       for (i=0; i<thread_index; i++) {
-          if (!exitThreadArray[i]) break;
-       }
-       currentThread->Exit(i==thread_index, exitcode);
+       currentThread->Exit(pidTable->NumLive() == 0, exitcode);
     }
     else if ((which == SyscallException) && (type == SYScall_Exec)) {
        // Copy the executable name into kernel space
@@ -314,4 +311,11 @@ ExceptionHandler(ExceptionType which)
 	printf("Unexpected user mode exception %d %d\n", which, type);
 	ASSERT(FALSE);
     }
+
+    // A thread this call made ready -- a forked child, or one it woke --
+    // may be owed the CPU under a preemptive policy.  An interrupt handler
+    // hands it over with YieldOnReturn; a system call yields here, once
+    // the program counters have been advanced.
+    if ((which == SyscallException) && scheduler->PreemptPending())
+       currentThread->YieldCPU();
 }
@@ -30,8 +30,9 @@ TimerHandler(int dummy) {
            delete ptr;
         }
         //printf("[%d] Timer interrupt.\n", stats->totalTicks);
-        // TODO: according to schedulerCode
-        if(scheduler->schedulerCode>=3)
+        if (numCPUs > 1)
+            PreemptProcessors();        // each CPU checks its own thread
+        else if(scheduler->ShouldPreempt(currentThread))
         {
             currentThread->yieldAt=true;
         interrupt->YieldOnReturn();
@@ -56,6 +57,7 @@ StartUserProcess(char *filename)
 	return;
     }
     space = new ProcessAddrSpace(executable);    
+    delete currentThread->space;	// the old program's, on an Exec
     currentThread->space = space;
 
     delete executable;			// close file
@@ -119,15 +121,34 @@ ForkStartFunctionBatch (int dummy)
 }
 
 
-void
-ExecIndCommands(char *filename, int priority) {
+//----------------------------------------------------------------------
+// ExecIndCommands
+// 	Start one batch job running "filename" with the given priority,
+//	in fair-share group "group".  A job with a (relative) deadline is
+//	subject to EDF admission control on its worst-case execution
+//	ticks "wcet"; "period" is 0 for a one-shot job.  Return the pid
+//	of the job, or -1 if it could not be started.
+//----------------------------------------------------------------------
+
+int
+ExecIndCommands(char *filename, int priority, int deadline, int period, int wcet,
+		int group) {
     OpenFile *executable = fileSystem->Open(filename);
     if (executable == NULL) {
         printf("Unable to open file %s\n", filename);
-        return;
+        return -1;
+    }
+    if (deadline > 0
+            && !scheduler->AdmitDeadline(EDFUtilization(deadline, period, wcet), group)) {
+        printf("Rejecting %s: deadline %d cannot be guaranteed\n", filename, deadline);
+        stats->deadline_rejected++;
+        delete executable;
+        return -1;
     }
 
     NachOSThread *currThread = new NachOSThread(filename, priority);
+    burstHistory->Seed(currThread, filename);
+    scheduler->DeclareJob(currThread, group, deadline, period, wcet);
     ProcessAddrSpace *space = new ProcessAddrSpace(executable);
     currThread->space = space;
 
@@ -139,6 +160,208 @@ ExecIndCommands(char *filename, int priority) {
     currThread->AllocateThreadStack(ForkStartFunctionBatch,0);
     currThread->Schedule();
     //printf("pid from prog=%d\n",currThread->GetPID());
+    return currThread->GetPID();
+}
+
+//----------------------------------------------------------------------
+// ParseGroup
+// 	Take the group tag "@name[:share]" out of the fields of a batch
+//	line, and return the id of that group, registering it if it is
+//	new.  Without a tag, or with too many groups, the job is in the
+//	default group 0.
+//----------------------------------------------------------------------
+
+static int
+ParseGroup(char *fields)
+{
+    char *tag = strchr(fields, '@');
+    char name[GROUP_NAME_LEN];
+    int share = 1;
+    int group, n;
+
+    if (tag == NULL)
+        return 0;
+    name[0] = '\0';
+    sscanf(tag + 1, "%15[^: \t]:%d", name, &share);
+    for (n = 0; tag[n] != '\0' && tag[n] != ' ' && tag[n] != '\t'; n++)
+        tag[n] = ' ';           // leave the numbers to the caller
+    if (name[0] == '\0')
+        return 0;
+    if (share < 1)
+        share = 1;
+    group = stats->AddGroup(name, share);
+    if (group < 0) {
+        printf("Too many groups, %s runs in the default group\n", name);
+        return 0;
+    }
+    return group;
+}
+
+//----------------------------------------------------------------------
+// LookupQuantum
+// 	Return the quantum "name" stands for in a batch file: a number of
+//	ticks, or one of the names saved by CalibrateQuanta (A, Q1..Q4).
+//	Return -1 if the name is not known.
+//----------------------------------------------------------------------
+
+static int
+LookupQuantum(char *name)
+{
+    FILE *fp;
+    char key[16];
+    int ticks, found = -1;
+
+    if (name[0] >= '0' && name[0] <= '9')
+        return atoi(name);
+    fp = fopen(CALIBRATION_FILE, "r");
+    if (fp == NULL)
+        return -1;
+    while (fscanf(fp, "%15s %d", key, &ticks) == 2) {
+        if (!strcmp(key, name)) {
+            found = ticks;
+            break;
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+//----------------------------------------------------------------------
+// CalibrationRun
+// 	Run "copies" copies of the program "filename" to completion under
+//	scheduler "code", with the timer programmed for "quantum", and
+//	return the CPU utilization over the run.  Called by the main
+//	thread, which sleeps in Join meanwhile.
+//
+//	The copies may fork, and leave children running that are not ours
+//	to Join.  The main thread then sleeps until they are gone too,
+//	woken by each exit to count the live threads again, so that the
+//	CPU is idle, not busy, while they are blocked.  Each thread's
+//	address space is freed with it, so the next run has all of memory
+//	again.
+//----------------------------------------------------------------------
+
+static double
+CalibrationRun(char *filename, int copies, int code, int quantum)
+{
+    int startTicks = stats->totalTicks;
+    int startBusy = stats->systemTicks + stats->userTicks;
+    int *pids = new int[copies];
+    int c, which;
+
+    scheduler->SetPolicy(code, FALSE);
+    for (c = 1; c < numCPUs; c++)
+        processors[c]->readyQueue->SetPolicy(code, FALSE);
+    for (c = 0; c < numCPUs; c++)
+        processors[c]->readyQueue->SetTimerPeriod(quantum);
+    timer->quantum_timer = quantum;
+
+    for (c = 0; c < copies; c++)
+        pids[c] = ExecIndCommands(filename, 100, 0, 0, 0, 0);
+    for (c = 0; c < copies; c++) {
+        which = currentThread->CheckIfChild(pids[c]);
+        if (which >= 0)
+            currentThread->JoinWithChild(which);
+    }
+    while (pidTable->NumLive() > 1)         // forked descendants
+        pidTable->WaitForExit();
+    delete [] pids;
+
+    return (stats->systemTicks + stats->userTicks - startBusy)
+            / (double)(stats->totalTicks - startTicks);
+}
+
+//----------------------------------------------------------------------
+// CalibrateQuanta
+// 	Derive the scheduling quanta from the behavior of the program
+//	"filename", instead of by hand.  "copies" copies are run together:
+//
+//	1. Under FCFS, to measure A, the average CPU burst between
+//	   blocking calls, and Q1..Q3 from it.
+//	2. Under round robin with a quantum of the longest burst seen,
+//	   which is as good as FCFS, to find the highest utilization.
+//	3. Under round robin again, binary searching between MIN_QUANTUM
+//	   and that for Q4, the smallest quantum within
+//	   CALIBRATION_TOLERANCE of the highest utilization.
+//
+//	Only Q4 is searched for.  Q1..Q3 are A/4, A/2 and 3A/4 by
+//	definition: they are the quanta to compare against the program's
+//	bursts, short of, about and past the average, not ones that
+//	maximize anything.
+//
+//	The quanta are printed and saved in CALIBRATION_FILE, then Nachos
+//	halts.
+//----------------------------------------------------------------------
+
+void
+CalibrateQuanta(char *filename, int copies)
+{
+    OpenFile *executable = fileSystem->Open(filename);
+    FILE *fp;
+    double best, util;
+    int average, lo, hi, mid, i;
+    int quanta[4];
+
+    if (executable == NULL) {
+        printf("Unable to open file %s\n", filename);
+        return;
+    }
+    delete executable;
+    if (burstHistory == NULL)
+        burstHistory = new BurstHistory(BURST_HISTORY_FILE);
+    timer = new Timer(TimerHandler, 0, false, MIN_QUANTUM);
+
+    stats->io_burst_count = stats->io_burst_total = 0;
+    stats->io_burst_min = stats->io_burst_max = 0;
+    util = CalibrationRun(filename, copies, 1, MIN_QUANTUM);
+    if (stats->io_burst_count == 0) {
+        printf("%s ran no CPU bursts\n", filename);
+        return;
+    }
+    average = (stats->io_burst_total + stats->io_burst_count / 2)
+                / stats->io_burst_count;
+    printf("\nQuantum Calibration for %d copies of %s\n", copies, filename);
+    printf("FCFS: %d bursts, min %d, max %d, average A = %d, utilization %f\n",
+            stats->io_burst_count, stats->io_burst_min, stats->io_burst_max,
+            average, util);
+    for (i = 0; i < 3; i++) {
+        quanta[i] = average * (i + 1) / 4;
+        if (quanta[i] < MIN_QUANTUM)
+            quanta[i] = MIN_QUANTUM;
+    }
+
+    hi = stats->io_burst_max;
+    if (hi < MIN_QUANTUM)
+        hi = MIN_QUANTUM;
+    best = CalibrationRun(filename, copies, 3, hi);
+    printf("RR quantum %5d: utilization %f\n", hi, best);
+    lo = MIN_QUANTUM;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        util = CalibrationRun(filename, copies, 3, mid);
+        printf("RR quantum %5d: utilization %f\n", mid, util);
+        if (util >= best - CALIBRATION_TOLERANCE)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    quanta[3] = hi;
+
+    printf("A %d, Q1 %d, Q2 %d, Q3 %d, Q4 %d\n", average,
+            quanta[0], quanta[1], quanta[2], quanta[3]);
+    fp = fopen(CALIBRATION_FILE, "w");
+    if (fp == NULL)
+        printf("Unable to write %s\n", CALIBRATION_FILE);
+    else {
+        fprintf(fp, "A %d\n", average);
+        for (i = 0; i < 4; i++)
+            fprintf(fp, "Q%d %d\n", i + 1, quanta[i]);
+        fclose(fp);
+    }
+
+    // done: exit like the batch loader does
+    pidTable->Exited(currentThread->GetPID());
+    currentThread->Exit(pidTable->NumLive() == 0, 0);
 }
 
 void
@@ -159,41 +382,47 @@ ExecFileCommands (char *filename)
     
     int i = 0, j = 0;
     char execFile[50];
-    char priority[5];
-    char schedCode[5];
+    char fields[80];
+    char quantumName[16];
+    int code = 1;
 
-    // first line is for schedulerCode
+    // first line is: schedulerCode [quantum], the quantum in ticks or
+    // the name of a calibrated one
     while (i < lengthOfFile && data[i] != '\n') {
-        schedCode[j] = data[i];
+        if (j < (int)sizeof(fields) - 1)
+            fields[j++] = data[i];
         i++;
-        j++;
-    }
-    schedCode[j] = '\0';
-    scheduler->schedulerCode = atoi(schedCode);
-
-    // TODO: update quantum
-    int quantum = 100;
-    int schedulerType = scheduler->schedulerCode;
-    if (schedulerType <=2)
-        quantum = 100;
-    else if (schedulerType == 3)
-        quantum = 30;
-    else if (schedulerType == 4)
-        quantum = 60;
-    else if (schedulerType == 5)
-        quantum = 90;
-    else if (schedulerType == 6)
-        quantum = 30;
-    else if (schedulerType == 7)
-        quantum = 40;
-    else if (schedulerType == 8)
-        quantum = 70;
-    else if (schedulerType == 9)
-        quantum = 90;
-    else if (schedulerType == 10)
-        quantum = 40;
-    else
-        quantum = 100;
+    }
+    fields[j] = '\0';
+    quantumName[0] = '\0';
+    sscanf(fields, "%d %15s", &code, quantumName);
+
+    // Any group tag in the jobs turns on fair sharing between groups;
+    // untagged jobs, and the main thread, are in group "default"
+    bool byGroup = FALSE;
+    for (j = i; j < lengthOfFile; j++)
+        if (data[j] == '@')
+            byGroup = TRUE;
+    if (byGroup)
+        stats->AddGroup("default", 1);
+    scheduler->SetPolicy(code, byGroup);
+    for (int c = 1; c < numCPUs; c++)
+        processors[c]->readyQueue->SetPolicy(code, byGroup);
+
+    if (burstHistory == NULL)
+        burstHistory = new BurstHistory(BURST_HISTORY_FILE);
+
+    // The policy knows its quantum, unless the batch file names one
+    int quantum = scheduler->TimerPeriod();
+    if (quantumName[0] != '\0') {
+        int q = LookupQuantum(quantumName);
+        if (q > 0)
+            quantum = q;
+        else
+            printf("Unknown quantum %s, using %d\n", quantumName, quantum);
+        for (int c = 0; c < numCPUs; c++)
+            processors[c]->readyQueue->SetTimerPeriod(quantum);
+    }
 
     timer = new Timer(TimerHandler, 0 , false, quantum);
 
@@ -208,38 +437,33 @@ ExecFileCommands (char *filename)
         }
         execFile[j] = '\0';
 
-        if (data[i] == '\n')
-        {
-            priority[0] = '1';   // if priority is not mentioned default = 100
-            priority[1] = '0';
-            priority[2] = '0';
-            priority[3]='\0';
-            //j=0;
-        }
-        else {
+        // the rest of the line is: [priority [deadline [period [wcet]]]]
+        // and, anywhere, [@group[:share]]
+        int priority_val = 100;     // if priority is not mentioned default = 100
+        int deadline = 0, period = 0, wcet = 0;
+        int group = 0;
+        if (i < lengthOfFile && data[i] != '\n') {
             i++;
             j = 0;
             
             while (i < lengthOfFile && data[i] != '\n') {
-                priority[j] = data[i];
-                j++;
+                if (j < (int)sizeof(fields) - 1)
+                    fields[j++] = data[i];
                 i++;
             }
-            // priority[j] = '\0';
+            fields[j] = '\0';
+            group = ParseGroup(fields);
+            sscanf(fields, "%d %d %d %d", &priority_val, &deadline, &period, &wcet);
         }
         i++;    // next line
-        int priority_val = atoi(priority);
-        ExecIndCommands(execFile, priority_val);
+        ExecIndCommands(execFile, priority_val, deadline, period, wcet, group);
     }
     delete dataFile;
 
     //code from system call Exit
     
-    exitThreadArray[currentThread->GetPID()] = true;
+    pidTable->Exited(currentThread->GetPID());
 
     // Find out if all threads have called exit
-    for (i=0; i<thread_index; i++) {
-        if (!exitThreadArray[i]) break;
-    }
-    currentThread->Exit(i==thread_index, 0);
+    currentThread->Exit(pidTable->NumLive() == 0, 0);
 }
\ No newline at end of file